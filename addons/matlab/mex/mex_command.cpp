@@ -250,7 +250,7 @@ void handler_DistanceQuery (int, mxArray *plhs[], int, const mxArray *prhs[])
 	}
 }
 
-void handler_CollisionQuery (int, mxArray *plhs[], int, const mxArray *prhs[])
+void handler_CollisionQuery (int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
 	if ( !mxIsChar( RHS_ARG_2 ) )
 	{
@@ -262,6 +262,18 @@ void handler_CollisionQuery (int, mxArray *plhs[], int, const mxArray *prhs[])
 		ERROR_MSG(INVALID_ARG, "Third argument must be a space name.");
 	}
 
+	// Contact points are only worth working out when they are returned as
+	// well as the number of colliding pairs
+	std::string mode( (nlhs > 1) ? "contacts" : "pairs" );
+	if ( nrhs > 3 )
+	{
+		if ( !mxIsChar( RHS_ARG_4 ) )
+		{
+			ERROR_MSG(INVALID_ARG, "Fourth argument must be 'contacts', 'pairs' or 'first'.");
+		}
+		mode = StringMx::convert(RHS_ARG_4);
+	}
+
 	try
 	{
 		SceneObject* s1 = g_SceneGraph->getObject( StringMx::convert(RHS_ARG_2) );
@@ -273,8 +285,10 @@ void handler_CollisionQuery (int, mxArray *plhs[], int, const mxArray *prhs[])
 
 			args.parameters.push_back(
 					Property("CollisionPair", SceneObjectPair(s1, s2)) );
+			args.parameters.push_back( Property("mode", mode) );
 			g_SceneGraph->executeQuery( "ODECollisionQuery", args );
 			LHS_ARG_1 = mxCreateDoubleScalar( (double)args.objectsInCollision.size() );
+			if ( nlhs > 1 ) LHS_ARG_2 = MxContactData::convert(args, *g_SceneGraph);
 		}
 		else
 		{
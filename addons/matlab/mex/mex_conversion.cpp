@@ -7,6 +7,8 @@
 
 #include "mex_conversion.h"
 
+#include <cstring>
+
 /* ----------------------------------------------------------------------------
  * StringMx
  *
@@ -446,6 +448,54 @@ mxArray* MxQueryArguments::convert(const QueryArguments& args)
 	return mxQueryResults;
 };
 
+/* ----------------------------------------------------------------------------
+ * MxContactData
+ *
+ */
+mxArray* MxContactData::convert(const QueryArguments& args, const SceneGraph& graph)
+{
+	const char* fieldNames[] = {"objects", "offsets", "positions", "normals", "depths"};
+	mxArray* mxContacts = mxCreateStructMatrix(1,1,5,fieldNames);
+
+	int numPairs = args.objectsInCollision.size();
+	mxArray* mxObjects = mxCreateCellMatrix(2, numPairs);
+	for (int n=0; n < numPairs; ++n)
+	{
+		const SceneObjectPair& pair = args.objectsInCollision[n];
+		// Objects that do not belong to graph get an empty name
+		NameHandle first = graph.getObjectHandle(pair.first);
+		NameHandle second = graph.getObjectHandle(pair.second);
+		mxSetCell(mxObjects, 2*n, mxCreateString( (first != NameTable::InvalidHandle) ? graph.getName(first).c_str() : "" ));
+		mxSetCell(mxObjects, 2*n+1, mxCreateString( (second != NameTable::InvalidHandle) ? graph.getName(second).c_str() : "" ));
+	}
+
+	// The contacts of pair n are columns offsets(n)+1 to offsets(n+1). The
+	// arrays are copied over whole, the layouts already match.
+	int numOffsets = args.contactOffsets.size();
+	int numContacts = args.contactDepths.size();
+	mxArray* mxOffsets = mxCreateNumericMatrix(1, numOffsets, mxUINT32_CLASS, mxREAL);
+	mxArray* mxPositions = mxCreateNumericMatrix(3, numContacts, mxSINGLE_CLASS, mxREAL);
+	mxArray* mxNormals = mxCreateNumericMatrix(3, numContacts, mxSINGLE_CLASS, mxREAL);
+	mxArray* mxDepths = mxCreateNumericMatrix(1, numContacts, mxSINGLE_CLASS, mxREAL);
+
+	if ( numOffsets > 0 )
+		memcpy(mxGetData(mxOffsets), &args.contactOffsets[0], numOffsets * sizeof(unsigned int));
+	if ( numContacts > 0 )
+	{
+		memcpy(mxGetData(mxPositions), &args.contactPositions[0], 3 * numContacts * sizeof(float));
+		memcpy(mxGetData(mxNormals), &args.contactNormals[0], 3 * numContacts * sizeof(float));
+		memcpy(mxGetData(mxDepths), &args.contactDepths[0], numContacts * sizeof(float));
+	}
+
+	mxSetField(mxContacts, 0, "objects", mxObjects);
+	mxSetField(mxContacts, 0, "offsets", mxOffsets);
+	mxSetField(mxContacts, 0, "positions", mxPositions);
+	mxSetField(mxContacts, 0, "normals", mxNormals);
+	mxSetField(mxContacts, 0, "depths", mxDepths);
+
+	return mxContacts;
+};
+
 /* ----------------------------------------------------------------------------
  * MxSceneGraph
  *
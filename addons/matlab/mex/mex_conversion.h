@@ -34,6 +34,7 @@ struct MxSceneObject;
 struct MxObjectIterator;
 struct MxSceneNode;
 struct MxQueryArguments;
+struct MxContactData;
 struct MxSceneGraph;
 
 struct StringMx
@@ -158,6 +159,15 @@ struct MxQueryArguments
 	static mxArray* convert(const QueryArguments& args);
 };
 
+/*
+ * Collision query results: the names of the colliding objects and their
+ * contacts, as one array per field rather than a struct per contact.
+ */
+struct MxContactData
+{
+	static mxArray* convert(const QueryArguments& args, const SceneGraph& graph);
+};
+
 struct MxSceneGraph
 {
 	MxSceneGraph(SceneGraph& g);
@@ -228,21 +228,21 @@ void SpaceAttributesBuilder::getParameters()
 	// First set default parameters.
 	// The parameters are dependent on the type of space
 	//	simple:	No parameters
-	//	hash:	center,	dVector3
+	//	hash:	minlevel,	int
+	//			maxlevel,	int
+	//	quadtree:	center,	dVector3
 	//			extents,	dVector3
 	//			depth,	int
-	//	quatree:	minlevel,	int
-	//			maxlevel,	int
 	std::string type = attrib_->getValAsStr("type");
 	
 	if (!type.compare("simple")) return; // No parameters for simple space
 	else if (!type.compare("hash")) {
-		attrib_->add("center", "0 0 0");
-		attrib_->add("extents", "0 0 0");
-		attrib_->add("depth", "4");
-	} else if (!type.compare("quadtree")) {
 		attrib_->add("minlevel", "-1");
 		attrib_->add("maxlevel", "8");
+	} else if (!type.compare("quadtree")) {
+		attrib_->add("center", "0 0 0");
+		attrib_->add("extents", "10 10 10");
+		attrib_->add("depth", "4");
 	} else {
 		return;
 	}
@@ -168,21 +168,25 @@ void XMLSceneBuilder::buildSpaces(tinysg::SceneGraph& graph)
 			}
 			else if (spaceType.compare("hash") == 0)
 			{
-				dRealPtr center = attrib->getValAsVec("center", 3);
-				dRealPtr extents = attrib->getValAsVec("extents", 3);
-				float depth = attrib->getValAsReal("depth");
-				
-				//spaceID = dQuadTreeSpaceCreate(parentID, center.get(), extents.get(), (int)depth);
-				std::cout << "The ODE plugin for TinySG only supports SimpleSpaces." << std::endl;
+				float minlevel = attrib->getValAsReal("minlevel");
+				float maxlevel = attrib->getValAsReal("maxlevel");
+
+				PropertyContainer space_properties;
+				space_properties.push_back( Property("min_level", int(minlevel)) );
+				space_properties.push_back( Property("max_level", int(maxlevel)) );
+				space = graph.createObject(attrib->getValAsStr("name"), "ODEHashSpace", space_properties);
 			}
 			else if (spaceType.compare("quadtree") == 0)
 			{
-				//spaceID = dHashSpaceCreate(parentID);
-				
-				float minlevel = attrib->getValAsReal("minlevel");
-				float maxlevel = attrib->getValAsReal("maxlevel");
-				//dHashSpaceSetLevels(spaceID, (int)minlevel, (int)maxlevel);
-				std::cout << "The ODE plugin for TinySG only supports SimpleSpaces." << std::endl;
+				dRealPtr center = attrib->getValAsVec("center", 3);
+				dRealPtr extents = attrib->getValAsVec("extents", 3);
+				float depth = attrib->getValAsReal("depth");
+
+				PropertyContainer space_properties;
+				space_properties.push_back( Property("center", Vector3((center.get())[0], (center.get())[1], (center.get())[2])) );
+				space_properties.push_back( Property("extents", Vector3((extents.get())[0], (extents.get())[1], (extents.get())[2])) );
+				space_properties.push_back( Property("depth", int(depth)) );
+				space = graph.createObject(attrib->getValAsStr("name"), "ODEQuadTreeSpace", space_properties);
 			}
 		
 			//Then create a new space object
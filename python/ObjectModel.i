@@ -1,5 +1,13 @@
+%include "std_vector.i"
+
 %{
 #include <api/ObjectModel.h>
 %}
 
+// QueryArguments hands contacts and distances back in these
+namespace std {
+	%template(FloatVector) vector<float>;
+	%template(UIntVector) vector<unsigned int>;
+}
+
 %include "api/ObjectModel.h"
\ No newline at end of file
@@ -156,25 +156,13 @@ void OArchive::serialize(SceneGraph& graph, ObjectInfo& info, int& ver)
 	addAttribute(objectElement, "type", info.type);
 
 	// Get object properties
+	TiXmlElement* elementMemory = currXmlElement;
+	currXmlElement = objectElement;
 	BOOST_FOREACH( Property prop, info.parameters )
 	{
-		TiXmlElement* propElement = createXmlNode(objectElement, Archive::PropertyTagName);
-
-#ifdef DEBUG_TRACE
-		std::cout << "- Property: " << prop.name_str() << std::endl;
-#endif
-		addAttribute(propElement, "name", prop.name_str());
-		StringTuple tuple = stringify(prop.const_value());
-#ifdef DEBUG_TRACE
-		if ( prop.name_str() == "filename" )
-		{
-			//std::cout << "-- filename: " << boost::any_cast<std::string>(prop.value()) << std::endl;
-			std::cout << "-- filename: " << tuple.first << ", " << tuple.second << std::endl;
-		}
-#endif
-		addAttribute(propElement, "class", tuple.first);
-		addAttribute(propElement, "value", tuple.second);
+		serialize(graph, prop, ver);
 	}
+	currXmlElement = elementMemory;
 #ifdef DEBUG_TRACE
 	std::cout << "Object Serialized: " << info.name << std::endl;
 #endif
@@ -182,7 +170,32 @@ void OArchive::serialize(SceneGraph& graph, ObjectInfo& info, int& ver)
 
 void OArchive::serialize(SceneGraph& graph, Property& prop, int& ver)
 {
+	TiXmlElement* propElement = createXmlNode(currXmlElement, Archive::PropertyTagName);
 
+#ifdef DEBUG_TRACE
+	std::cout << "- Property: " << prop.name_str() << std::endl;
+#endif
+	addAttribute(propElement, "name", prop.name_str());
+	StringTuple tuple = stringify(prop.const_value());
+#ifdef DEBUG_TRACE
+	if ( prop.name_str() == "filename" )
+	{
+		//std::cout << "-- filename: " << boost::any_cast<std::string>(prop.value()) << std::endl;
+		std::cout << "-- filename: " << tuple.first << ", " << tuple.second << std::endl;
+	}
+#endif
+	addAttribute(propElement, "class", tuple.first);
+	addAttribute(propElement, "value", tuple.second);
+
+	// Nested properties go inside this one, which is where IArchive looks
+	// for them
+	TiXmlElement* elementMemory = currXmlElement;
+	currXmlElement = propElement;
+	BOOST_FOREACH( Property parameter, prop.get_parameters() )
+	{
+		serialize(graph, parameter, ver);
+	}
+	currXmlElement = elementMemory;
 }
 
 TiXmlElement* OArchive::createXmlNode(TiXmlElement* parent, const std::string& name)
@@ -0,0 +1,137 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * BatchQuery.cpp
+ *
+ *  Created on: Apr 20, 2009
+ *      Author: yamokosk
+ */
+
+#include "BatchQuery.h"
+#include "SceneGraph.h"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+
+namespace tinysg
+{
+
+#if defined( TSG_HAVE_LOG4CXX )
+log4cxx::LoggerPtr BatchQuery::logger( log4cxx::Logger::getLogger("TinySG.BatchQuery") );
+#endif
+
+void BatchQueryResults::clear()
+{
+	distanceOffsets.assign(1, 0);
+	distances.clear();
+	critpnt.clear();
+	regpnt.clear();
+	collisionOffsets.assign(1, 0);
+	collisions.clear();
+}
+
+void BatchQueryResults::append(const QueryArguments& args, const SceneGraph& graph)
+{
+	distances.insert(distances.end(), args.distanceMap.begin(), args.distanceMap.end());
+	critpnt.insert(critpnt.end(), args.critpnt.begin(), args.critpnt.end());
+	regpnt.insert(regpnt.end(), args.regpnt.begin(), args.regpnt.end());
+	distanceOffsets.push_back( (unsigned int)distances.size() );
+
+	for (unsigned int n = 0; n < args.objectsInCollision.size(); ++n)
+	{
+		const SceneObjectPair& pair = args.objectsInCollision[n];
+		collisions.push_back( std::make_pair(graph.getObjectHandle(pair.first), graph.getObjectHandle(pair.second)) );
+	}
+	collisionOffsets.push_back( (unsigned int)collisions.size() );
+}
+
+void BatchQueryResults::append(const BatchQueryResults& other)
+{
+	unsigned int distanceBase = distanceOffsets.back();
+	unsigned int collisionBase = collisionOffsets.back();
+	for (unsigned int k = 1; k < other.distanceOffsets.size(); ++k)
+	{
+		distanceOffsets.push_back( distanceBase + other.distanceOffsets[k] );
+		collisionOffsets.push_back( collisionBase + other.collisionOffsets[k] );
+	}
+
+	distances.insert(distances.end(), other.distances.begin(), other.distances.end());
+	critpnt.insert(critpnt.end(), other.critpnt.begin(), other.critpnt.end());
+	regpnt.insert(regpnt.end(), other.regpnt.begin(), other.regpnt.end());
+	collisions.insert(collisions.end(), other.collisions.begin(), other.collisions.end());
+}
+
+BatchQuery::BatchQuery(const std::vector<SceneGraph*>& scenes) :
+	scenes_(scenes),
+	threadPool_( scenes.empty() ? 1 : scenes.size() ),
+	partial_( scenes.size() )
+{
+}
+
+void BatchQuery::execute(const std::string& querytype, const std::vector<std::string>& nodes,
+						 const float* poses, unsigned int numConfigs, BatchQueryResults& results,
+						 const PropertyContainer& parameters)
+{
+	results.clear();
+	if ( scenes_.empty() || numConfigs == 0 ) return;
+
+	// Handles are looked up per scene, in case the copies were built in a
+	// different order
+	std::vector< std::vector<NameHandle> > handles( scenes_.size(), std::vector<NameHandle>(nodes.size()) );
+	for (unsigned int s = 0; s < scenes_.size(); ++s)
+	{
+		for (unsigned int n = 0; n < nodes.size(); ++n)
+		{
+			handles[s][n] = scenes_[s]->getHandle(nodes[n]);
+			if ( scenes_[s]->getNode(handles[s][n]) == NULL )
+			{
+				TSG_LOG_ERROR( "Batch query: scene " << s << " has no node \"" << nodes[n] << "\"." );
+				return;
+			}
+		}
+
+		// Plugins create their queries through the shared plugin manager, so
+		// do it here rather than from the workers
+		if ( scenes_[s]->getQuery(querytype) == NULL )
+		{
+			TSG_LOG_ERROR( "Batch query: scene " << s << " could not create a \"" << querytype << "\" query." );
+			return;
+		}
+	}
+
+	// One contiguous block of configurations per scene
+	unsigned int numScenes = std::min<unsigned int>( (unsigned int)scenes_.size(), numConfigs );
+	for (unsigned int s = 0; s < numScenes; ++s)
+	{
+		unsigned int first = (unsigned int)( (unsigned long)numConfigs * s / numScenes );
+		unsigned int last = (unsigned int)( (unsigned long)numConfigs * (s+1) / numScenes );
+		const float* block = poses + 7 * nodes.size() * first;
+
+		boost::threadpool::schedule( threadPool_,
+			boost::bind(&SceneGraph::executeBatchQuery, scenes_[s], boost::cref(querytype), boost::cref(handles[s]),
+						block, last - first, boost::ref(partial_[s]), boost::cref(parameters)) );
+	}
+	threadPool_.wait();
+
+	for (unsigned int s = 0; s < numScenes; ++s)
+	{
+		results.append(partial_[s]);
+	}
+}
+
+}
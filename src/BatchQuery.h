@@ -0,0 +1,107 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * BatchQuery.h
+ *
+ *  Created on: Apr 20, 2009
+ *      Author: yamokosk
+ */
+
+#ifndef _TINYSG_BATCH_QUERY_H_FILE_
+#define _TINYSG_BATCH_QUERY_H_FILE_
+
+#include "config.h"
+#include "NameTable.h"
+
+#include <api/ObjectModel.h>
+
+#include <string>
+#include <vector>
+
+#include "threadpool.hpp"
+
+namespace tinysg
+{
+
+// Forward declaration
+class SceneGraph;
+
+/*
+ * Results of a batch query, packed configuration after configuration.
+ * Configuration k owns entries distanceOffsets[k] up to distanceOffsets[k+1]
+ * of distances, critpnt and regpnt, and entries collisionOffsets[k] up to
+ * collisionOffsets[k+1] of collisions.
+ */
+struct BatchQueryResults
+{
+	BatchQueryResults() {clear();}
+
+	void clear();
+	//! Appends the results of one more configuration
+	void append(const QueryArguments& args, const SceneGraph& graph);
+	//! Appends all configurations of other
+	void append(const BatchQueryResults& other);
+
+	unsigned int getNumConfigs() const {return (unsigned int)distanceOffsets.size() - 1;}
+
+	std::vector<unsigned int> distanceOffsets;
+	std::vector<float> distances;
+	std::vector<Point3D> critpnt;
+	std::vector<Point3D> regpnt;
+
+	std::vector<unsigned int> collisionOffsets;
+	// Handles of the colliding objects, see SceneGraph::getObject(NameHandle)
+	std::vector< std::pair<NameHandle, NameHandle> > collisions;
+};
+
+/*
+ * Spreads the configurations of a batch query over several copies of one
+ * scene, one worker thread per copy. Each copy has its own nodes and plugin
+ * state, so configurations running at the same time share nothing. Load the
+ * copies from the same scene file, so that object handles in the results
+ * mean the same in all of them.
+ */
+class BatchQuery
+{
+#if defined( TSG_HAVE_LOG4CXX )
+	static log4cxx::LoggerPtr logger;
+#endif
+
+public:
+	//! The scenes must outlive the batch query
+	explicit BatchQuery(const std::vector<SceneGraph*>& scenes);
+
+	//! Same as SceneGraph::executeBatchQuery(), with nodes given by name.
+	//! Logs an error and leaves results empty if a scene lacks one of the
+	//! nodes or the query.
+	void execute(const std::string& querytype, const std::vector<std::string>& nodes,
+				 const float* poses, unsigned int numConfigs, BatchQueryResults& results,
+				 const PropertyContainer& parameters = PropertyContainer());
+
+	unsigned int getNumScenes() const {return (unsigned int)scenes_.size();}
+
+private:
+	std::vector<SceneGraph*> scenes_;
+	boost::threadpool::pool threadPool_;
+	// Results of each scene's block of configurations
+	std::vector<BatchQueryResults> partial_;
+};
+
+}
+
+#endif
@@ -0,0 +1,488 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * BinaryArchive.cpp
+ *
+ *  Created on: Mar 30, 2009
+ *      Author: yamokosk
+ */
+
+
+#include "BinaryArchive.h"
+
+#include "SceneGraph.h"
+#include "SceneNode.h"
+#include "Stringify.h"
+
+#include <fstream>
+
+#include <boost/static_assert.hpp>
+
+#include <linalg/Vector3.h>
+#include <linalg/Quaternion.h>
+using namespace obrsp::linalg;
+
+BOOST_STATIC_ASSERT( sizeof(tinysg::BinarySceneHeader) == 64 );
+BOOST_STATIC_ASSERT( sizeof(tinysg::BinaryObjectRecord) == 24 );
+
+namespace tinysg
+{
+
+const char BinaryArchive::Magic[4] = {'T', 'S', 'G', 'B'};
+const boost::uint32_t BinaryArchive::FormatVersion(2);
+const boost::uint32_t BinaryArchive::ByteOrderMark(0x01020304);
+
+#if defined( TSG_HAVE_LOG4CXX )
+log4cxx::LoggerPtr BinaryArchive::logger( log4cxx::Logger::getLogger("TinySG.BinaryArchive") );
+#endif
+
+static boost::uint64_t align8(boost::uint64_t offset)
+{
+	return (offset + 7) & ~(boost::uint64_t)7;
+}
+
+bool BinaryArchive::isBinaryFile(const std::string& f)
+{
+	std::ifstream file(f.c_str(), std::ios::in | std::ios::binary);
+	char magic[4] = {0, 0, 0, 0};
+	file.read(magic, 4);
+	return ( file.gcount() == 4 && memcmp(magic, Magic, 4) == 0 );
+}
+
+BinaryArchive::BinaryArchive(const std::string& f, Direction d) :
+	Archive(f),
+	direction_(d),
+	currParent_(-1),
+	currNode_(0),
+	currObject_(0),
+	blobStart_(0),
+	cursor_(0)
+{
+	memset(&header_, 0, sizeof(header_));
+}
+
+void BinaryArchive::init()
+{
+	if ( direction_ == Output ) return;
+
+	// Everything else works out of the mapping
+	file_.reset( new MappedFile(filename) );
+
+	if ( file_->size() < sizeof(BinarySceneHeader) )
+	{
+		throw std::string(filename + " is too short to be a binary scene file.");
+	}
+	memcpy(&header_, file_->data(), sizeof(header_));
+
+	if ( memcmp(header_.magic, Magic, 4) != 0 )
+	{
+		throw std::string(filename + " is not a binary scene file.");
+	}
+	if ( header_.byteOrder != ByteOrderMark )
+	{
+		throw std::string(filename + " was written on a machine with a different byte order.");
+	}
+	if ( header_.formatVersion != FormatVersion )
+	{
+		throw std::string(filename + " uses an unsupported binary format version.");
+	}
+	if ( header_.fileSize != file_->size() )
+	{
+		throw std::string(filename + " is truncated.");
+	}
+
+	// String table
+	boost::uint32_t count;
+	memcpy(&count, section(header_.stringsOffset, sizeof(count)), sizeof(count));
+	const boost::uint32_t* offsets = reinterpret_cast<const boost::uint32_t*>(
+		section(header_.stringsOffset + sizeof(count), (boost::uint64_t)count * sizeof(boost::uint32_t)) );
+	boost::uint64_t chars = header_.stringsOffset + sizeof(count) + (boost::uint64_t)count * sizeof(boost::uint32_t);
+
+	names_.resize(count);
+	for (boost::uint32_t n = 0; n < count; ++n)
+	{
+		const char* str = section(chars + offsets[n], 1);
+		if ( memchr(str, '\0', file_->size() - (str - file_->data())) == NULL )
+		{
+			throw std::string(filename + " has an unterminated string.");
+		}
+		names_[n] = str;
+	}
+
+	// Make sure the tables are really there before anything points into them
+	section(header_.nodesOffset, (boost::uint64_t)header_.numNodes * sizeof(BinaryNodeRecord));
+	section(header_.objectsOffset, (boost::uint64_t)header_.numObjects * sizeof(BinaryObjectRecord));
+	blobStart_ = header_.blobOffset;
+	section(blobStart_, 0);
+}
+
+void BinaryArchive::serialize(SceneGraph& graph, int& ver)
+{
+	if ( direction_ == Output )
+	{
+		strings_ = NameTable();
+		nodes_.clear();
+		objects_.clear();
+		blob_.clear();
+
+		// World node first, the rest follow depth first
+		currParent_ = -1;
+		serialize(graph, *(graph.getNode(SceneGraph::World)), ver);
+
+		writeFile(ver);
+		return;
+	}
+
+	ver = header_.sceneVersion;
+
+	if ( header_.numNodes == 0 )
+	{
+		throw std::string("Binary scene file " + filename + " has no world node.");
+	}
+	const BinaryNodeRecord* nodes = reinterpret_cast<const BinaryNodeRecord*>(file_->data() + header_.nodesOffset);
+	if ( getString(nodes[0].name) != SceneGraph::World )
+	{
+		throw std::string("World node was not the first node in the binary archive.");
+	}
+
+	// Nodes are stored parents first, so every parent has been created by the
+	// time its children are read. They are looked up by index, not by name.
+	loaded_.assign(header_.numNodes, NULL);
+	loaded_[0] = graph.getNode(SceneGraph::World);
+	for (currNode_ = 0; currNode_ < header_.numNodes; ++currNode_)
+	{
+		if ( currNode_ > 0 ) loaded_[currNode_] = graph.createNode( getString(nodes[currNode_].name) );
+		serialize(graph, *loaded_[currNode_], ver);
+	}
+	loaded_.clear();
+}
+
+void BinaryArchive::serialize(SceneGraph& graph, SceneNode& node, int& ver)
+{
+	if ( direction_ == Output )
+	{
+		BinaryNodeRecord record;
+		record.name = addString(node.getName());
+		record.parent = currParent_;
+		memcpy(record.position, node.getPosition().ptr(), sizeof(record.position));
+		memcpy(record.orientation, node.getOrientation().ptr(), sizeof(record.orientation));
+		record.firstObject = (boost::uint32_t)objects_.size();
+		record.numObjects = node.getNumAttachedObjects();
+
+		boost::int32_t index = (boost::int32_t)nodes_.size();
+		nodes_.push_back(record);
+
+		// A node's objects are written next to each other so the record only
+		// needs the first one and a count
+		SceneObjectIterator objects = node.getAttachedObjects();
+		while ( objects.hasMoreElements() )
+		{
+			ObjectInfo info;
+			objects.getNext()->getInfo(info);
+			serialize(graph, info, ver);
+		}
+
+		SceneNode::ChildIterator children = node.getChildren();
+		while ( children.hasMoreElements() )
+		{
+			currParent_ = index;
+			serialize(graph, *children.getNext(), ver);
+		}
+		return;
+	}
+
+	const BinaryNodeRecord& record =
+		reinterpret_cast<const BinaryNodeRecord*>(file_->data() + header_.nodesOffset)[currNode_];
+
+	if ( record.parent >= 0 )
+	{
+		if ( (boost::uint32_t)record.parent >= currNode_ )
+		{
+			throw std::string("Node " + node.getName() + " is stored before its parent.");
+		}
+		TSG_LOG_DEBUG( "Setting parent of " << node.getName() << " to " << loaded_[record.parent]->getName() );
+		loaded_[record.parent]->addChild(&node);
+	}
+
+	node.setPosition( Vector3(record.position[0], record.position[1], record.position[2]) );
+	node.setOrientation( Quaternion(record.orientation[0], record.orientation[1],
+									record.orientation[2], record.orientation[3]) );
+
+	if ( (boost::uint64_t)record.firstObject + record.numObjects > header_.numObjects )
+	{
+		throw std::string("Node " + node.getName() + " refers to objects past the end of the object table.");
+	}
+	for (boost::uint32_t n = 0; n < record.numObjects; ++n)
+	{
+		currObject_ = record.firstObject + n;
+
+		ObjectInfo info;
+		serialize(graph, info, ver);
+		SceneObject* sceneObject = graph.createObject(info);
+		if ( sceneObject != NULL ) node.attach( sceneObject );
+	}
+}
+
+void BinaryArchive::serialize(SceneGraph& graph, ObjectInfo& info, int& ver)
+{
+	if ( direction_ == Output )
+	{
+		BinaryObjectRecord record;
+		record.name = addString(info.name);
+		record.type = addString(info.type);
+		record.numProperties = (boost::uint32_t)info.parameters.size();
+		record.padding = 0;
+
+		record.propertyOffset = blob_.size();
+		BOOST_FOREACH( Property& prop, info.parameters )
+		{
+			serialize(graph, prop, ver);
+		}
+
+		objects_.push_back(record);
+		return;
+	}
+
+	const BinaryObjectRecord& record =
+		reinterpret_cast<const BinaryObjectRecord*>(file_->data() + header_.objectsOffset)[currObject_];
+
+	info.name = getString(record.name);
+	info.type = getString(record.type);
+
+	cursor_ = record.propertyOffset;
+	for (boost::uint32_t n = 0; n < record.numProperties; ++n)
+	{
+		Property parameter("unknown");
+		serialize(graph, parameter, ver);
+		info.addProperty(parameter);
+	}
+
+	TSG_LOG_INFO( "Creating scene object \"" << info.name << "\"." );
+}
+
+void BinaryArchive::serialize(SceneGraph& graph, Property& prop, int& ver)
+{
+	if ( direction_ == Output )
+	{
+		append( addString(prop.name_str()) );
+
+		// Same type checks, in the same order, as stringify()
+		const boost::any& value = prop.const_value();
+		if ( is_obj_empty(value) ) {
+			append( (boost::uint32_t)BPC_EMPTY );
+			append( (boost::uint32_t)0 );
+		} else if ( is_int(value) ) {
+			append( (boost::uint32_t)BPC_INT );
+			append( (boost::uint32_t)sizeof(boost::int32_t) );
+			append( (boost::int32_t)boost::any_cast<int>(value) );
+		} else if ( is_real(value) ) {
+			append( (boost::uint32_t)BPC_REAL );
+			append( (boost::uint32_t)sizeof(float) );
+			append( (float)boost::any_cast<Real>(value) );
+		} else if ( is_unsigned_long(value) ) {
+			append( (boost::uint32_t)BPC_UNSIGNED_LONG );
+			append( (boost::uint32_t)sizeof(boost::uint64_t) );
+			append( (boost::uint64_t)boost::any_cast<unsigned long>(value) );
+		} else if ( is_char_ptr(value) ) {
+			append( (boost::uint32_t)BPC_STRING );
+			append( (boost::uint32_t)sizeof(boost::uint32_t) );
+			append( addString( boost::any_cast<char*>(value) ) );
+		} else if ( is_string(value) ) {
+			append( (boost::uint32_t)BPC_STRING );
+			append( (boost::uint32_t)sizeof(boost::uint32_t) );
+			append( addString( boost::any_cast<std::string>(value) ) );
+		} else if ( is_vector_3(value) ) {
+			Vector3 v( boost::any_cast<Vector3>(value) );
+			append( (boost::uint32_t)BPC_VECTOR3 );
+			append( (boost::uint32_t)(3 * sizeof(float)) );
+			appendArray(v.ptr(), 3 * sizeof(float));
+		} else if ( is_quaternion(value) ) {
+			Quaternion q( boost::any_cast<Quaternion>(value) );
+			append( (boost::uint32_t)BPC_QUATERNION );
+			append( (boost::uint32_t)(4 * sizeof(float)) );
+			appendArray(q.ptr(), 4 * sizeof(float));
+		} else if ( is_scene_object_ptr(value) ) {
+			ObjectInfo info;
+			boost::any_cast<SceneObject*>(value)->getInfo(info);
+			append( (boost::uint32_t)BPC_SCENE_OBJECT_PTR );
+			append( (boost::uint32_t)sizeof(boost::uint32_t) );
+			append( addString(info.name) );
+		} else {
+			append( (boost::uint32_t)BPC_UNKNOWN );
+			append( (boost::uint32_t)0 );
+		}
+
+		const PropertyContainer& parameters = prop.get_parameters();
+		append( (boost::uint32_t)parameters.size() );
+		BOOST_FOREACH( Property parameter, parameters )
+		{
+			serialize(graph, parameter, ver);
+		}
+		return;
+	}
+
+	prop.set_name( std::string( getString( read<boost::uint32_t>() ) ) );
+	boost::uint32_t propertyClass = read<boost::uint32_t>();
+	boost::uint32_t size = read<boost::uint32_t>();
+	boost::uint64_t next = cursor_ + size;
+	section(blobStart_ + cursor_, size);
+
+	switch ( propertyClass )
+	{
+	case BPC_INT:
+		prop.set_value( boost::any( (int)read<boost::int32_t>() ) );
+		break;
+	case BPC_UNSIGNED_LONG:
+		prop.set_value( boost::any( (unsigned long)read<boost::uint64_t>() ) );
+		break;
+	case BPC_REAL:
+		prop.set_value( boost::any( (Real)read<float>() ) );
+		break;
+	case BPC_STRING:
+		prop.set_value( boost::any( std::string( getString( read<boost::uint32_t>() ) ) ) );
+		break;
+	case BPC_VECTOR3:
+	{
+		float v[3];
+		memcpy(v, section(blobStart_ + cursor_, sizeof(v)), sizeof(v));
+		prop.set_value( boost::any( Vector3(v[0], v[1], v[2]) ) );
+		break;
+	}
+	case BPC_QUATERNION:
+	{
+		float q[4];
+		memcpy(q, section(blobStart_ + cursor_, sizeof(q)), sizeof(q));
+		prop.set_value( boost::any( Quaternion(q[0], q[1], q[2], q[3]) ) );
+		break;
+	}
+	case BPC_SCENE_OBJECT_PTR:
+		prop.set_value( boost::any( graph.getObject( getString( read<boost::uint32_t>() ) ) ) );
+		break;
+	default:
+		// Empty and unknown values come back the same way the XML archive
+		// returns them
+		prop.set_value(Archive::UnknownValue);
+		break;
+	}
+	cursor_ = next;
+
+	boost::uint32_t count = read<boost::uint32_t>();
+	for (boost::uint32_t n = 0; n < count; ++n)
+	{
+		Property parameter("unknown");
+		serialize(graph, parameter, ver);
+		prop.add_parameter(parameter);
+	}
+}
+
+boost::uint32_t BinaryArchive::addString(const std::string& s)
+{
+	return strings_.intern(s);
+}
+
+void BinaryArchive::appendArray(const void* data, size_t bytes)
+{
+	if ( bytes == 0 ) return;
+	const char* p = static_cast<const char*>(data);
+	blob_.insert(blob_.end(), p, p + bytes);
+}
+
+void BinaryArchive::writeFile(int ver)
+{
+	// Lay out the string table: count, offsets, then the characters
+	std::vector<boost::uint32_t> offsets(strings_.size());
+	boost::uint32_t chars = 0;
+	for (NameHandle n = 0; n < strings_.size(); ++n)
+	{
+		offsets[n] = chars;
+		chars += (boost::uint32_t)strings_.getName(n).size() + 1;
+	}
+	boost::uint32_t count = strings_.size();
+
+	BinarySceneHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, Magic, 4);
+	header.formatVersion = FormatVersion;
+	header.byteOrder = ByteOrderMark;
+	header.sceneVersion = ver;
+	header.numNodes = (boost::uint32_t)nodes_.size();
+	header.numObjects = (boost::uint32_t)objects_.size();
+	header.stringsOffset = align8( sizeof(header) );
+	header.nodesOffset = align8( header.stringsOffset + sizeof(count) + count * sizeof(boost::uint32_t) + chars );
+	header.objectsOffset = align8( header.nodesOffset + nodes_.size() * sizeof(BinaryNodeRecord) );
+	header.blobOffset = align8( header.objectsOffset + objects_.size() * sizeof(BinaryObjectRecord) );
+	header.fileSize = header.blobOffset + blob_.size();
+
+	std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if ( !file )
+	{
+		throw std::string("Could not open " + filename + " for writing.");
+	}
+
+	static const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+	boost::uint64_t written = 0;
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	written += sizeof(header);
+
+	file.write(padding, header.stringsOffset - written);
+	file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+	if ( count > 0 ) file.write(reinterpret_cast<const char*>(&offsets[0]), count * sizeof(boost::uint32_t));
+	for (NameHandle n = 0; n < strings_.size(); ++n)
+	{
+		file.write(strings_.getName(n).c_str(), strings_.getName(n).size() + 1);
+	}
+	written = header.stringsOffset + sizeof(count) + count * sizeof(boost::uint32_t) + chars;
+
+	file.write(padding, header.nodesOffset - written);
+	if ( !nodes_.empty() ) file.write(reinterpret_cast<const char*>(&nodes_[0]), nodes_.size() * sizeof(BinaryNodeRecord));
+	written = header.nodesOffset + nodes_.size() * sizeof(BinaryNodeRecord);
+
+	file.write(padding, header.objectsOffset - written);
+	if ( !objects_.empty() ) file.write(reinterpret_cast<const char*>(&objects_[0]), objects_.size() * sizeof(BinaryObjectRecord));
+	written = header.objectsOffset + objects_.size() * sizeof(BinaryObjectRecord);
+
+	file.write(padding, header.blobOffset - written);
+	if ( !blob_.empty() ) file.write(&blob_[0], blob_.size());
+
+	if ( !file )
+	{
+		throw std::string("Failed to write binary scene file " + filename + ".");
+	}
+	TSG_LOG_INFO( "Wrote " << header.numNodes << " nodes and " << header.numObjects << " objects to " << filename << "." );
+}
+
+const char* BinaryArchive::section(boost::uint64_t offset, boost::uint64_t bytes) const
+{
+	if ( offset > file_->size() || bytes > file_->size() - offset )
+	{
+		throw std::string("Binary scene file " + filename + " is corrupt: data runs past the end of the file.");
+	}
+	return file_->data() + offset;
+}
+
+const char* BinaryArchive::getString(boost::uint32_t index) const
+{
+	if ( index >= names_.size() )
+	{
+		throw std::string("Binary scene file " + filename + " is corrupt: bad string index.");
+	}
+	return names_[index];
+}
+
+}
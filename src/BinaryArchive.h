@@ -0,0 +1,210 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * BinaryArchive.h
+ *
+ *  Created on: Mar 30, 2009
+ *      Author: yamokosk
+ */
+
+
+#ifndef _TINYSG_BINARY_ARCHIVE_H_FILE_
+#define _TINYSG_BINARY_ARCHIVE_H_FILE_
+
+#include "config.h"
+
+#include <string>
+#include <vector>
+#include <cstring>
+
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "Archive.h"
+#include "NameTable.h"
+#include "MappedFile.h"
+
+namespace tinysg
+{
+
+/*
+ * On-disk layout of a binary scene file. All integers and floats are stored
+ * in the byte order of the machine that wrote the file; the byteOrder field
+ * lets a reader detect a mismatch. Every section starts on an 8 byte boundary
+ * and every record inside a section on a 4 byte boundary, so the file can be
+ * used in place once it is in memory.
+ *
+ *   BinarySceneHeader
+ *   string table    uint32 count, uint32 offsets[count], NUL terminated chars
+ *   node table      BinaryNodeRecord[numNodes], parents before children
+ *   object table    BinaryObjectRecord[numObjects], grouped by node
+ *   blob            properties, referenced from the object table
+ *
+ * Strings (names, types, string values) are stored once and referenced by
+ * index. Node 0 is always the world node.
+ *
+ * Meshes are not stored. The ones getInfo() hands out are world space copies
+ * for display, and objects rebuild their geometry from their own properties
+ * (e.g. "filename") when they are created. Version 1 files still had mesh
+ * fields in the object records and are rejected.
+ */
+struct BinarySceneHeader
+{
+	char magic[4];
+	boost::uint32_t formatVersion;
+	boost::uint32_t byteOrder;
+	boost::int32_t sceneVersion;
+	boost::uint32_t numNodes;
+	boost::uint32_t numObjects;
+	boost::uint64_t stringsOffset;
+	boost::uint64_t nodesOffset;
+	boost::uint64_t objectsOffset;
+	boost::uint64_t blobOffset;
+	boost::uint64_t fileSize;
+};
+
+struct BinaryNodeRecord
+{
+	boost::uint32_t name;
+	// Index into the node table, -1 for the world node
+	boost::int32_t parent;
+	float position[3];
+	// w, x, y, z
+	float orientation[4];
+	boost::uint32_t firstObject;
+	boost::uint32_t numObjects;
+};
+
+struct BinaryObjectRecord
+{
+	boost::uint32_t name;
+	boost::uint32_t type;
+	boost::uint32_t numProperties;
+	// Always 0, keeps propertyOffset on an 8 byte boundary
+	boost::uint32_t padding;
+	// Blob offset of the first property
+	boost::uint64_t propertyOffset;
+};
+
+/*
+ * A property in the blob is
+ *
+ *   uint32 name, uint32 class, uint32 payload size, payload, uint32 count,
+ *   followed by count nested properties.
+ */
+enum BinaryPropertyClass
+{
+	BPC_EMPTY = 0,
+	BPC_INT,
+	BPC_UNSIGNED_LONG,
+	BPC_REAL,
+	// Also used for char*, which comes back as a std::string
+	BPC_STRING,
+	BPC_VECTOR3,
+	BPC_QUATERNION,
+	// Payload is the index of the object's name
+	BPC_SCENE_OBJECT_PTR,
+	BPC_UNKNOWN
+};
+
+/*
+ * Binary archive. One class handles both directions since the reader and
+ * writer share the section bookkeeping.
+ *
+ * Input maps the file and reads the tables straight from the mapping, but
+ * nothing is used in place: names, poses and property values are copied into
+ * the graph, and the mapping goes away with the archive.
+ */
+class BinaryArchive : public Archive
+{
+#if defined( TSG_HAVE_LOG4CXX )
+	static log4cxx::LoggerPtr logger;
+#endif
+
+public:
+	enum Direction
+	{
+		Input,
+		Output
+	};
+
+	static const char Magic[4];
+	static const boost::uint32_t FormatVersion;
+	static const boost::uint32_t ByteOrderMark;
+
+	//! True if the file starts with the binary scene magic
+	static bool isBinaryFile(const std::string& f);
+
+	BinaryArchive(const std::string& f, Direction d);
+	virtual ~BinaryArchive() {};
+
+	virtual void init();
+	virtual void serialize(SceneGraph& object, int& ver);
+
+private:
+	virtual void serialize(SceneGraph& graph, SceneNode& object, int& ver);
+	virtual void serialize(SceneGraph& graph, ObjectInfo& object, int& ver);
+	virtual void serialize(SceneGraph& graph, Property& prop, int& ver);
+
+	// Output helpers
+	boost::uint32_t addString(const std::string& s);
+	template <class T>
+	void append(const T& value)
+	{
+		const char* p = reinterpret_cast<const char*>(&value);
+		blob_.insert(blob_.end(), p, p + sizeof(T));
+	}
+	void appendArray(const void* data, size_t bytes);
+	void writeFile(int ver);
+
+	// Input helpers
+	const char* section(boost::uint64_t offset, boost::uint64_t bytes) const;
+	const char* getString(boost::uint32_t index) const;
+	template <class T>
+	T read()
+	{
+		T value;
+		memcpy(&value, section(blobStart_ + cursor_, sizeof(T)), sizeof(T));
+		cursor_ += sizeof(T);
+		return value;
+	}
+
+	Direction direction_;
+
+	// Output state
+	NameTable strings_;
+	std::vector<BinaryNodeRecord> nodes_;
+	std::vector<BinaryObjectRecord> objects_;
+	std::vector<char> blob_;
+	boost::int32_t currParent_;
+
+	// Input state
+	boost::shared_ptr<MappedFile> file_;
+	BinarySceneHeader header_;
+	// Point into the string table
+	std::vector<const char*> names_;
+	std::vector<SceneNode*> loaded_;
+	boost::uint32_t currNode_;
+	boost::uint32_t currObject_;
+	boost::uint64_t blobStart_;
+	boost::uint64_t cursor_;
+};
+
+}
+
+#endif
@@ -0,0 +1,111 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * MappedFile.cpp
+ *
+ *  Created on: Apr 2, 2009
+ *      Author: yamokosk
+ */
+
+
+#include "MappedFile.h"
+
+#if TINYSG_PLATFORM == TINYSG_PLATFORM_WIN32
+#	include <fstream>
+#else
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+namespace tinysg
+{
+
+#if TINYSG_PLATFORM == TINYSG_PLATFORM_WIN32
+
+MappedFile::MappedFile(const std::string& filename) :
+	filename_(filename),
+	data_(NULL),
+	size_(0)
+{
+	std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+	if ( !file )
+	{
+		throw std::string("Could not open " + filename + ".");
+	}
+
+	file.seekg(0, std::ios::end);
+	buffer_.resize( (size_t)file.tellg() );
+	file.seekg(0, std::ios::beg);
+	if ( !buffer_.empty() ) file.read(&buffer_[0], buffer_.size());
+
+	data_ = buffer_.empty() ? NULL : &buffer_[0];
+	size_ = buffer_.size();
+}
+
+MappedFile::~MappedFile()
+{
+
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filename) :
+	filename_(filename),
+	data_(NULL),
+	size_(0)
+{
+	int fd = open(filename.c_str(), O_RDONLY);
+	if ( fd < 0 )
+	{
+		throw std::string("Could not open " + filename + ".");
+	}
+
+	struct stat info;
+	if ( fstat(fd, &info) != 0 )
+	{
+		close(fd);
+		throw std::string("Could not stat " + filename + ".");
+	}
+	size_ = (size_t)info.st_size;
+
+	// mmap refuses empty files; leave data_ NULL for those
+	if ( size_ > 0 )
+	{
+		void* p = mmap(NULL, size_, PROT_READ, MAP_SHARED, fd, 0);
+		if ( p == MAP_FAILED )
+		{
+			close(fd);
+			throw std::string("Could not map " + filename + ".");
+		}
+		data_ = static_cast<const char*>(p);
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+	if ( data_ != NULL ) munmap( const_cast<char*>(data_), size_ );
+}
+
+#endif
+
+}
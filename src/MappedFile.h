@@ -0,0 +1,68 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * MappedFile.h
+ *
+ *  Created on: Apr 2, 2009
+ *      Author: yamokosk
+ */
+
+
+#ifndef _TINYSG_MAPPED_FILE_H_FILE_
+#define _TINYSG_MAPPED_FILE_H_FILE_
+
+#include "config.h"
+
+#include <string>
+#include <vector>
+
+namespace tinysg
+{
+
+/*
+ * Read-only view of a whole file. On POSIX systems the file is mapped, so
+ * pages are only read when touched and are shared between every process
+ * that maps the same file. Elsewhere the file is read into memory.
+ *
+ * Throws a std::string if the file can not be opened or mapped.
+ */
+class MappedFile
+{
+public:
+	explicit MappedFile(const std::string& filename);
+	~MappedFile();
+
+	const char* data() const {return data_;}
+	size_t size() const {return size_;}
+	const std::string& getFilename() const {return filename_;}
+
+private:
+	// Not copyable
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+	std::string filename_;
+	const char* data_;
+	size_t size_;
+	// Only used where mmap is not available
+	std::vector<char> buffer_;
+};
+
+}
+
+#endif
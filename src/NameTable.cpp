@@ -0,0 +1,101 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * NameTable.cpp
+ *
+ *  Created on: Mar 23, 2009
+ *      Author: yamokosk
+ */
+
+#include "NameTable.h"
+
+namespace tinysg
+{
+
+const NameHandle NameTable::InvalidHandle(0xFFFFFFFF);
+
+// Number of buckets to start with; always a power of two
+static const unsigned int InitialBuckets = 64;
+
+NameTable::NameTable() :
+	buckets_(InitialBuckets, 0)
+{
+
+}
+
+NameHandle NameTable::intern(const std::string& name)
+{
+	unsigned int h = hash(name);
+	unsigned int bucket = locate(name, h);
+	if ( buckets_[bucket] != 0 ) return buckets_[bucket] - 1;
+
+	NameHandle handle = (NameHandle)names_.size();
+	names_.push_back(name);
+	hashes_.push_back(h);
+	buckets_[bucket] = handle + 1;
+
+	if ( 2 * names_.size() > buckets_.size() ) grow();
+	return handle;
+}
+
+NameHandle NameTable::find(const std::string& name) const
+{
+	unsigned int bucket = locate(name, hash(name));
+	return ( buckets_[bucket] != 0 ) ? buckets_[bucket] - 1 : InvalidHandle;
+}
+
+unsigned int NameTable::hash(const std::string& name)
+{
+	// 32 bit FNV-1a
+	unsigned int h = 2166136261u;
+	for (std::string::size_type n = 0; n < name.size(); ++n)
+	{
+		h ^= (unsigned char)name[n];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+unsigned int NameTable::locate(const std::string& name, unsigned int h) const
+{
+	// Returns the bucket holding name, or the empty bucket where it would go.
+	// Never loops forever since the table is at most half full.
+	unsigned int mask = (unsigned int)buckets_.size() - 1;
+	for (unsigned int bucket = h & mask; ; bucket = (bucket + 1) & mask)
+	{
+		unsigned int entry = buckets_[bucket];
+		if ( entry == 0 ) return bucket;
+		if ( hashes_[entry - 1] == h && names_[entry - 1] == name ) return bucket;
+	}
+}
+
+void NameTable::grow()
+{
+	std::vector<unsigned int> buckets(2 * buckets_.size(), 0);
+	unsigned int mask = (unsigned int)buckets.size() - 1;
+
+	for (NameHandle handle = 0; handle < names_.size(); ++handle)
+	{
+		unsigned int bucket = hashes_[handle] & mask;
+		while ( buckets[bucket] != 0 ) bucket = (bucket + 1) & mask;
+		buckets[bucket] = handle + 1;
+	}
+	buckets_.swap(buckets);
+}
+
+}
@@ -0,0 +1,76 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * NameTable.h
+ *
+ *  Created on: Mar 23, 2009
+ *      Author: yamokosk
+ */
+
+#ifndef _TINYSG_NAME_TABLE_H_FILE_
+#define _TINYSG_NAME_TABLE_H_FILE_
+
+#include "config.h"
+
+#include <string>
+#include <vector>
+
+namespace tinysg
+{
+
+//! Integer stand-in for an interned name.
+typedef unsigned int NameHandle;
+
+/*
+ * Interns names and hands out dense integer handles, starting at 0, in the
+ * order names are first seen. A handle stays valid for the lifetime of the
+ * table, so it can index plain vectors and be cached by callers.
+ *
+ * Lookup is an open addressing hash table (linear probing, kept at most half
+ * full) of handles. The hash of every name is kept next to it so growing the
+ * table never rehashes a string.
+ */
+class NameTable
+{
+public:
+	static const NameHandle InvalidHandle;
+
+	NameTable();
+
+	//! Returns the handle for name, adding it if it is new.
+	NameHandle intern(const std::string& name);
+	//! Returns the handle for name or InvalidHandle if it was never interned.
+	NameHandle find(const std::string& name) const;
+
+	const std::string& getName(NameHandle handle) const {return names_[handle];}
+	unsigned int size() const {return (unsigned int)names_.size();}
+
+private:
+	static unsigned int hash(const std::string& name);
+	unsigned int locate(const std::string& name, unsigned int h) const;
+	void grow();
+
+	std::vector<std::string> names_;
+	std::vector<unsigned int> hashes_;
+	// handle + 1 per bucket, 0 marks an empty bucket
+	std::vector<unsigned int> buckets_;
+};
+
+}
+
+#endif
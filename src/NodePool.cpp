@@ -0,0 +1,82 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * NodePool.cpp
+ *
+ *  Created on: Mar 25, 2009
+ *      Author: yamokosk
+ */
+
+
+#include "NodePool.h"
+#include "SceneNode.h"
+
+#include <new>
+
+namespace tinysg
+{
+
+const unsigned int NodePool::NodesPerChunk(256);
+
+NodePool::NodePool() :
+	size_(0)
+{
+
+}
+
+NodePool::~NodePool()
+{
+	clear();
+}
+
+SceneNode* NodePool::construct(const std::string& name)
+{
+	unsigned int offset = size_ % NodesPerChunk;
+	if ( offset == 0 && size_ / NodesPerChunk == chunks_.size() )
+	{
+		// operator new memory is suitably aligned for any object
+		chunks_.push_back( static_cast<char*>( ::operator new(NodesPerChunk * sizeof(SceneNode)) ) );
+	}
+
+	void* mem = chunks_[size_ / NodesPerChunk] + offset * sizeof(SceneNode);
+	SceneNode* node = new (mem) SceneNode(name);
+	++size_;
+	return node;
+}
+
+SceneNode* NodePool::get(unsigned int n) const
+{
+	return reinterpret_cast<SceneNode*>( chunks_[n / NodesPerChunk] + (n % NodesPerChunk) * sizeof(SceneNode) );
+}
+
+void NodePool::clear()
+{
+	for (unsigned int n = 0; n < size_; ++n)
+	{
+		get(n)->~SceneNode();
+	}
+	size_ = 0;
+
+	for (unsigned int n = 0; n < chunks_.size(); ++n)
+	{
+		::operator delete(chunks_[n]);
+	}
+	chunks_.clear();
+}
+
+}
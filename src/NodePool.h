@@ -0,0 +1,76 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * NodePool.h
+ *
+ *  Created on: Mar 25, 2009
+ *      Author: yamokosk
+ */
+
+
+#ifndef _TINYSG_NODE_POOL_H_FILE_
+#define _TINYSG_NODE_POOL_H_FILE_
+
+#include "config.h"
+
+#include <string>
+#include <vector>
+
+namespace tinysg
+{
+
+// Forward declaration
+class SceneNode;
+
+/*
+ * Arena for the nodes of one SceneGraph. Nodes are constructed in place in
+ * chunks of NodesPerChunk, so building a graph costs one heap allocation per
+ * chunk rather than one per node, and nodes created together sit next to each
+ * other in memory.
+ *
+ * Nodes are never returned to the pool individually. clear() runs every
+ * node's destructor and hands the chunks back, one free per chunk.
+ */
+class NodePool
+{
+public:
+	static const unsigned int NodesPerChunk;
+
+	NodePool();
+	~NodePool();
+
+	SceneNode* construct(const std::string& name);
+	void clear();
+
+	//! Nodes constructed since the last clear(), in creation order
+	unsigned int size() const {return size_;}
+	SceneNode* get(unsigned int n) const;
+	unsigned int getNumChunks() const {return (unsigned int)chunks_.size();}
+
+private:
+	// Not copyable
+	NodePool(const NodePool&);
+	NodePool& operator=(const NodePool&);
+
+	std::vector<char*> chunks_;
+	unsigned int size_;
+};
+
+}
+
+#endif
@@ -0,0 +1,299 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * PoseKernel.cpp
+ *
+ *  Created on: Mar 16, 2009
+ *      Author: yamokosk
+ */
+
+#include "PoseKernel.h"
+
+// The SIMD kernels are compiled with per-function target attributes, so the
+// library itself does not need to be built with -msse/-mavx and still runs
+// on CPUs without them. Other compilers and platforms get the scalar kernel.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#	define TSG_HAVE_X86_KERNELS
+#	define TSG_TARGET(isa) __attribute__((target(isa)))
+#	include <immintrin.h>
+#endif
+
+namespace tinysg
+{
+
+static void compose_scalar(unsigned int first, unsigned int last, const int* parent,
+						   const float* lp, const float* lr, float* wp, float* wr)
+{
+	for (unsigned int i = first; i < last; ++i)
+	{
+		const float* q = wr + 4 * parent[i];
+		const float* pp = wp + 3 * parent[i];
+		const float* l = lr + 4 * i;
+		const float* v = lp + 3 * i;
+		float* oq = wr + 4 * i;
+		float* op = wp + 3 * i;
+
+		float w = q[0], x = q[1], y = q[2], z = q[3];
+
+		// Quaternion::operator*(const Quaternion&)
+		oq[0] = w * l[0] - x * l[1] - y * l[2] - z * l[3];
+		oq[1] = w * l[1] + x * l[0] + y * l[3] - z * l[2];
+		oq[2] = w * l[2] + y * l[0] + z * l[1] - x * l[3];
+		oq[3] = w * l[3] + z * l[0] + x * l[2] - y * l[1];
+
+		// Quaternion::operator*(const Vector3&) followed by the parent offset
+		float uvx = y * v[2] - z * v[1];
+		float uvy = z * v[0] - x * v[2];
+		float uvz = x * v[1] - y * v[0];
+		float uuvx = y * uvz - z * uvy;
+		float uuvy = z * uvx - x * uvz;
+		float uuvz = x * uvy - y * uvx;
+		float w2 = 2.0f * w;
+		uvx *= w2; uvy *= w2; uvz *= w2;
+		uuvx *= 2.0f; uuvy *= 2.0f; uuvz *= 2.0f;
+
+		op[0] = v[0] + uvx + uuvx + pp[0];
+		op[1] = v[1] + uvy + uuvy + pp[1];
+		op[2] = v[2] + uvz + uuvz + pp[2];
+	}
+}
+
+#if defined(TSG_HAVE_X86_KERNELS)
+
+// Four poses side by side, one register per component.
+struct Lanes4
+{
+	__m128 w, x, y, z;
+};
+
+TSG_TARGET("sse2") static inline Lanes4 load_quats4(const float* q0, const float* q1, const float* q2, const float* q3)
+{
+	__m128 r0 = _mm_loadu_ps(q0), r1 = _mm_loadu_ps(q1), r2 = _mm_loadu_ps(q2), r3 = _mm_loadu_ps(q3);
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	Lanes4 out = { r0, r1, r2, r3 };
+	return out;
+}
+
+TSG_TARGET("sse2") static inline Lanes4 load_vecs4(const float* v0, const float* v1, const float* v2, const float* v3)
+{
+	// Vectors are only 12 bytes wide, so a 16 byte load could run off the
+	// end of the array.
+	Lanes4 out;
+	out.x = _mm_set_ps(v3[0], v2[0], v1[0], v0[0]);
+	out.y = _mm_set_ps(v3[1], v2[1], v1[1], v0[1]);
+	out.z = _mm_set_ps(v3[2], v2[2], v1[2], v0[2]);
+	out.w = _mm_setzero_ps();
+	return out;
+}
+
+TSG_TARGET("sse2") static inline void store_quats4(Lanes4 q, float* out)
+{
+	_MM_TRANSPOSE4_PS(q.w, q.x, q.y, q.z);
+	_mm_storeu_ps(out, q.w);
+	_mm_storeu_ps(out + 4, q.x);
+	_mm_storeu_ps(out + 8, q.y);
+	_mm_storeu_ps(out + 12, q.z);
+}
+
+TSG_TARGET("sse2") static inline void store_vec3(__m128 v, float* out)
+{
+	// Write exactly three floats; the fourth belongs to the next slot, which
+	// another thread may own.
+	_mm_storel_pi((__m64*)out, v);
+	_mm_store_ss(out + 2, _mm_movehl_ps(v, v));
+}
+
+TSG_TARGET("sse2") static inline void store_vecs4(Lanes4 v, float* out)
+{
+	_MM_TRANSPOSE4_PS(v.x, v.y, v.z, v.w);
+	store_vec3(v.x, out);
+	store_vec3(v.y, out + 3);
+	store_vec3(v.z, out + 6);
+	store_vec3(v.w, out + 9);
+}
+
+TSG_TARGET("sse2") static void compose_sse(unsigned int first, unsigned int last, const int* parent,
+										   const float* lp, const float* lr, float* wp, float* wr)
+{
+	const __m128 two = _mm_set1_ps(2.0f);
+
+	unsigned int i = first;
+	for (; i + 4 <= last; i += 4)
+	{
+		const int* pi = parent + i;
+		Lanes4 q = load_quats4(wr + 4 * pi[0], wr + 4 * pi[1], wr + 4 * pi[2], wr + 4 * pi[3]);
+		Lanes4 pp = load_vecs4(wp + 3 * pi[0], wp + 3 * pi[1], wp + 3 * pi[2], wp + 3 * pi[3]);
+		Lanes4 l = load_quats4(lr + 4 * i, lr + 4 * i + 4, lr + 4 * i + 8, lr + 4 * i + 12);
+		Lanes4 v = load_vecs4(lp + 3 * i, lp + 3 * i + 3, lp + 3 * i + 6, lp + 3 * i + 9);
+
+		// Same operations, same order as compose_scalar()
+		Lanes4 oq;
+		oq.w = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(q.w, l.w), _mm_mul_ps(q.x, l.x)), _mm_mul_ps(q.y, l.y)), _mm_mul_ps(q.z, l.z));
+		oq.x = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(q.w, l.x), _mm_mul_ps(q.x, l.w)), _mm_mul_ps(q.y, l.z)), _mm_mul_ps(q.z, l.y));
+		oq.y = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(q.w, l.y), _mm_mul_ps(q.y, l.w)), _mm_mul_ps(q.z, l.x)), _mm_mul_ps(q.x, l.z));
+		oq.z = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(q.w, l.z), _mm_mul_ps(q.z, l.w)), _mm_mul_ps(q.x, l.y)), _mm_mul_ps(q.y, l.x));
+
+		__m128 uvx = _mm_sub_ps(_mm_mul_ps(q.y, v.z), _mm_mul_ps(q.z, v.y));
+		__m128 uvy = _mm_sub_ps(_mm_mul_ps(q.z, v.x), _mm_mul_ps(q.x, v.z));
+		__m128 uvz = _mm_sub_ps(_mm_mul_ps(q.x, v.y), _mm_mul_ps(q.y, v.x));
+		__m128 uuvx = _mm_sub_ps(_mm_mul_ps(q.y, uvz), _mm_mul_ps(q.z, uvy));
+		__m128 uuvy = _mm_sub_ps(_mm_mul_ps(q.z, uvx), _mm_mul_ps(q.x, uvz));
+		__m128 uuvz = _mm_sub_ps(_mm_mul_ps(q.x, uvy), _mm_mul_ps(q.y, uvx));
+		__m128 w2 = _mm_mul_ps(two, q.w);
+
+		Lanes4 op;
+		op.x = _mm_add_ps(_mm_add_ps(_mm_add_ps(v.x, _mm_mul_ps(uvx, w2)), _mm_mul_ps(uuvx, two)), pp.x);
+		op.y = _mm_add_ps(_mm_add_ps(_mm_add_ps(v.y, _mm_mul_ps(uvy, w2)), _mm_mul_ps(uuvy, two)), pp.y);
+		op.z = _mm_add_ps(_mm_add_ps(_mm_add_ps(v.z, _mm_mul_ps(uvz, w2)), _mm_mul_ps(uuvz, two)), pp.z);
+		op.w = _mm_setzero_ps();
+
+		store_quats4(oq, wr + 4 * i);
+		store_vecs4(op, wp + 3 * i);
+	}
+
+	compose_scalar(i, last, parent, lp, lr, wp, wr);
+}
+
+// Eight poses side by side. Loads and stores go through two groups of four
+// so the transposes can be shared with the SSE kernel.
+struct Lanes8
+{
+	__m256 w, x, y, z;
+};
+
+TSG_TARGET("avx") static inline __m256 join(__m128 lo, __m128 hi)
+{
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+TSG_TARGET("avx") static inline Lanes8 join(const Lanes4& lo, const Lanes4& hi)
+{
+	Lanes8 out = { join(lo.w, hi.w), join(lo.x, hi.x), join(lo.y, hi.y), join(lo.z, hi.z) };
+	return out;
+}
+
+TSG_TARGET("avx") static inline Lanes4 low(const Lanes8& v)
+{
+	Lanes4 out = { _mm256_castps256_ps128(v.w), _mm256_castps256_ps128(v.x), _mm256_castps256_ps128(v.y), _mm256_castps256_ps128(v.z) };
+	return out;
+}
+
+TSG_TARGET("avx") static inline Lanes4 high(const Lanes8& v)
+{
+	Lanes4 out = { _mm256_extractf128_ps(v.w, 1), _mm256_extractf128_ps(v.x, 1), _mm256_extractf128_ps(v.y, 1), _mm256_extractf128_ps(v.z, 1) };
+	return out;
+}
+
+TSG_TARGET("avx") static void compose_avx(unsigned int first, unsigned int last, const int* parent,
+										  const float* lp, const float* lr, float* wp, float* wr)
+{
+	const __m256 two = _mm256_set1_ps(2.0f);
+
+	unsigned int i = first;
+	for (; i + 8 <= last; i += 8)
+	{
+		const int* pi = parent + i;
+		Lanes8 q = join( load_quats4(wr + 4 * pi[0], wr + 4 * pi[1], wr + 4 * pi[2], wr + 4 * pi[3]),
+						 load_quats4(wr + 4 * pi[4], wr + 4 * pi[5], wr + 4 * pi[6], wr + 4 * pi[7]) );
+		Lanes8 pp = join( load_vecs4(wp + 3 * pi[0], wp + 3 * pi[1], wp + 3 * pi[2], wp + 3 * pi[3]),
+						  load_vecs4(wp + 3 * pi[4], wp + 3 * pi[5], wp + 3 * pi[6], wp + 3 * pi[7]) );
+		Lanes8 l = join( load_quats4(lr + 4 * i, lr + 4 * i + 4, lr + 4 * i + 8, lr + 4 * i + 12),
+						 load_quats4(lr + 4 * i + 16, lr + 4 * i + 20, lr + 4 * i + 24, lr + 4 * i + 28) );
+		Lanes8 v = join( load_vecs4(lp + 3 * i, lp + 3 * i + 3, lp + 3 * i + 6, lp + 3 * i + 9),
+						 load_vecs4(lp + 3 * i + 12, lp + 3 * i + 15, lp + 3 * i + 18, lp + 3 * i + 21) );
+
+		// Same operations, same order as compose_scalar()
+		Lanes8 oq;
+		oq.w = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(_mm256_mul_ps(q.w, l.w), _mm256_mul_ps(q.x, l.x)), _mm256_mul_ps(q.y, l.y)), _mm256_mul_ps(q.z, l.z));
+		oq.x = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(q.w, l.x), _mm256_mul_ps(q.x, l.w)), _mm256_mul_ps(q.y, l.z)), _mm256_mul_ps(q.z, l.y));
+		oq.y = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(q.w, l.y), _mm256_mul_ps(q.y, l.w)), _mm256_mul_ps(q.z, l.x)), _mm256_mul_ps(q.x, l.z));
+		oq.z = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(q.w, l.z), _mm256_mul_ps(q.z, l.w)), _mm256_mul_ps(q.x, l.y)), _mm256_mul_ps(q.y, l.x));
+
+		__m256 uvx = _mm256_sub_ps(_mm256_mul_ps(q.y, v.z), _mm256_mul_ps(q.z, v.y));
+		__m256 uvy = _mm256_sub_ps(_mm256_mul_ps(q.z, v.x), _mm256_mul_ps(q.x, v.z));
+		__m256 uvz = _mm256_sub_ps(_mm256_mul_ps(q.x, v.y), _mm256_mul_ps(q.y, v.x));
+		__m256 uuvx = _mm256_sub_ps(_mm256_mul_ps(q.y, uvz), _mm256_mul_ps(q.z, uvy));
+		__m256 uuvy = _mm256_sub_ps(_mm256_mul_ps(q.z, uvx), _mm256_mul_ps(q.x, uvz));
+		__m256 uuvz = _mm256_sub_ps(_mm256_mul_ps(q.x, uvy), _mm256_mul_ps(q.y, uvx));
+		__m256 w2 = _mm256_mul_ps(two, q.w);
+
+		Lanes8 op;
+		op.x = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(v.x, _mm256_mul_ps(uvx, w2)), _mm256_mul_ps(uuvx, two)), pp.x);
+		op.y = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(v.y, _mm256_mul_ps(uvy, w2)), _mm256_mul_ps(uuvy, two)), pp.y);
+		op.z = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(v.z, _mm256_mul_ps(uvz, w2)), _mm256_mul_ps(uuvz, two)), pp.z);
+		op.w = _mm256_setzero_ps();
+
+		store_quats4(low(oq), wr + 4 * i);
+		store_quats4(high(oq), wr + 4 * i + 16);
+		store_vecs4(low(op), wp + 3 * i);
+		store_vecs4(high(op), wp + 3 * i + 12);
+	}
+
+	compose_sse(i, last, parent, lp, lr, wp, wr);
+}
+
+#endif // TSG_HAVE_X86_KERNELS
+
+PoseKernelType best_pose_kernel()
+{
+#if defined(TSG_HAVE_X86_KERNELS)
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports("avx") ) return PK_AVX;
+	if ( __builtin_cpu_supports("sse2") ) return PK_SSE;
+#endif
+	return PK_SCALAR;
+}
+
+const char* pose_kernel_name(PoseKernelType type)
+{
+	switch ( type )
+	{
+	case PK_SCALAR:
+		return "scalar";
+	case PK_SSE:
+		return "SSE";
+	case PK_AVX:
+		return "AVX";
+	}
+	return "unknown";
+}
+
+void compose_poses(PoseKernelType type, unsigned int first, unsigned int last, const int* parent,
+				   const float* localPos, const float* localRot, float* worldPos, float* worldRot)
+{
+	// Never run a kernel the CPU can't execute, whatever the caller asked for
+	static const PoseKernelType supported = best_pose_kernel();
+	if ( type > supported ) type = supported;
+
+	switch ( type )
+	{
+#if defined(TSG_HAVE_X86_KERNELS)
+	case PK_AVX:
+		compose_avx(first, last, parent, localPos, localRot, worldPos, worldRot);
+		return;
+	case PK_SSE:
+		compose_sse(first, last, parent, localPos, localRot, worldPos, worldRot);
+		return;
+#endif
+	default:
+		compose_scalar(first, last, parent, localPos, localRot, worldPos, worldRot);
+		return;
+	}
+}
+
+} // End namespace tinysg
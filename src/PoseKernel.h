@@ -0,0 +1,61 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * PoseKernel.h
+ *
+ *  Created on: Mar 16, 2009
+ *      Author: yamokosk
+ */
+
+#ifndef _TINYSG_POSE_KERNEL_H_FILE_
+#define _TINYSG_POSE_KERNEL_H_FILE_
+
+namespace tinysg
+{
+
+//! Instruction sets the batched pose composition can run on.
+enum PoseKernelType
+{
+	PK_SCALAR,
+	PK_SSE,
+	PK_AVX
+};
+
+//! Best kernel the CPU we are running on supports.
+PoseKernelType best_pose_kernel();
+//! Human readable kernel name.
+const char* pose_kernel_name(PoseKernelType type);
+
+/*!
+ * Composes world poses for slots [first, last) from their parents':
+ *
+ *   worldRot[i] = worldRot[parent[i]] * localRot[i]
+ *   worldPos[i] = worldRot[parent[i]] * localPos[i] + worldPos[parent[i]]
+ *
+ * Positions are packed x,y,z and orientations w,x,y,z. Every parent must
+ * lie outside [first, last) and already hold its world pose. All kernels do
+ * the same float operations in the same order as the Quaternion and Vector3
+ * operators, so they give bit-identical results as long as the compiler does
+ * not fuse multiplies and adds (no -ffp-contract=fast with FMA enabled).
+ */
+void compose_poses(PoseKernelType type, unsigned int first, unsigned int last, const int* parent,
+				   const float* localPos, const float* localRot, float* worldPos, float* worldRot);
+
+} // End namespace tinysg
+
+#endif
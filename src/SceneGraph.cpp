@@ -18,6 +18,8 @@
 
 #include "SceneGraph.h"
 #include "Archive.h"
+#include "BinaryArchive.h"
+#include "XmlStreamReader.h"
 
 #include <iostream>
 #include <fstream>
@@ -48,6 +50,7 @@ log4cxx::LoggerPtr SceneGraph::logger( log4cxx::Logger::getLogger("TinySG.SceneG
 // Static member initialization
 unsigned long SceneGraph::NextGeneratedNameExt(0);
 const std::string SceneGraph::World("_WORLD_");
+const unsigned int SceneGraph::DefaultNumThreads(2);
 
 /*SceneGraph& SceneGraph::getInstance()
 {
@@ -79,12 +82,14 @@ int SceneGraph::InvokeService(const char* serviceName, void* serviceParams)
 	return 0;
 }
 
-SceneGraph::SceneGraph()
+SceneGraph::SceneGraph(unsigned int numThreads) :
+	threadPool_( (numThreads > 0) ? numThreads : 1 )
 {
-	TSG_LOG_DEBUG( "Scene graph initializing." );
+	TSG_LOG_DEBUG( "Scene graph initializing with " << threadPool_.size() << " update threads." );
 
 	rootNode_.reset( new SceneNode(World) );
 	rootNode_->setGraph(this);
+	nodes_[ internName(World) ] = rootNode_.get();
 	TSG_LOG_DEBUG( "Created world node." );
 
 	// Initialize plugin manager
@@ -123,42 +128,84 @@ SceneGraph::~SceneGraph()
 
 SceneNode* SceneGraph::createNode(const std::string& name)
 {
-	SceneNode* node = new SceneNode(name);
+	SceneNode* node = nodePool_.construct(name);
 	node->setGraph(this);
 
-	nodes_[name] = node;
+	NameHandle handle = internName(name);
+	if ( nodes_[handle] != NULL )
+	{
+		TSG_LOG_WARN( "Node \"" << name << "\" already exists. Name now refers to the new node." );
+	}
+	nodes_[handle] = node;
 	TSG_LOG_DEBUG( "Created node \"" << name << "\"." );
 	return node;
 }
 
 SceneNode* SceneGraph::getNode(const std::string& name) const
 {
-	if ( name == SceneGraph::World )
+	SceneNode* node = findNode(name);
+	if ( node == NULL )
 	{
-		return rootNode_.get();
+		TSG_LOG_WARN( "Node \"" << name << "\" does not exist in graph." );
+	}
+	return node;
+}
+
+SceneNode* SceneGraph::getNode(NameHandle handle) const
+{
+	if ( handle < nodes_.size() && nodes_[handle] != NULL )
+	{
+		return nodes_[handle];
 	} else {
-		NodeMap::const_iterator iter = nodes_.find(name);
+		TSG_LOG_WARN( "No node with handle " << handle << " exists in graph." );
+		return NULL;
+	}
+}
 
-		if ( iter != nodes_.end() )
-		{
-			return iter->second;
-		} else {
-			TSG_LOG_WARN( "Node \"" << name << "\" does not exist in graph." );
-			return NULL;
-		}
+SceneNode* SceneGraph::findNode(const std::string& name) const
+{
+	NameHandle handle = names_.find(name);
+	return ( handle < nodes_.size() ) ? nodes_[handle] : NULL;
+}
+
+NameHandle SceneGraph::getHandle(const std::string& name) const
+{
+	return names_.find(name);
+}
+
+NameHandle SceneGraph::internName(const std::string& name)
+{
+	NameHandle handle = names_.intern(name);
+	if ( nodes_.size() < names_.size() )
+	{
+		nodes_.resize(names_.size(), NULL);
+		objects_.resize(names_.size(), NULL);
 	}
+	return handle;
 }
 
 void SceneGraph::destroyAllNodes()
 {
-	TSG_LOG_INFO( "Destroying " << nodes_.size() << "." );
-	std::pair<std::string, SceneNode*> pair;
-	BOOST_FOREACH( pair, nodes_ )
+	TSG_LOG_INFO( "Destroying " << nodePool_.size() << " nodes." );
+
+	// Everything is going away, so cut all parent/child links up front,
+	// including the world node's. The destructors then have nothing to
+	// unlink and can run in any order.
+	rootNode_->children.clear();
+	for (unsigned int n = 0; n < nodePool_.size(); ++n)
+	{
+		SceneNode* node = nodePool_.get(n);
+		node->children.clear();
+		node->parent = NULL;
+	}
+	nodePool_.clear();
+	notifyTopologyChanged();
+
+	for (NameHandle handle = 0; handle < nodes_.size(); ++handle)
 	{
-		delete pair.second;
-		//n->removeAllChildren();
+		// The world node is owned by rootNode_
+		if ( nodes_[handle] != rootNode_.get() ) nodes_[handle] = NULL;
 	}
-	nodes_.clear();
 	TSG_LOG_INFO( "All nodes destroyed." );
 }
 
@@ -177,25 +224,71 @@ void SceneGraph::update(void)
 {
 	TSG_LOG_DEBUG( "SceneGraph::update()" );
 
-	// Create a thread pool with 4 threads
-	boost::threadpool::pool threadPool(2);
+	// Nodes added or removed since the last update leave the transform store
+	// out of order.
+	if ( !transforms_.isSorted() )
+	{
+		transforms_.sort(rootNode_.get());
+		TSG_LOG_DEBUG( "Transform store re-sorted. " << transforms_.getTreeSize() << " nodes in the world tree." );
+	}
 
-	// Pass a refernce to the thread pool to all nodes so that they can schedule
-	// themselves if need be.
-	rootNode_->update(threadPool);
+	// Hands subtrees of the graph to the thread pool. Returns once every node
+	// has been updated.
+	updater_.update(transforms_, threadPool_);
 
-	threadPool.wait();	// wait until all partitions are sorted
+	notifyPluginData();
 }
 
 void SceneGraph::__deprecated_update()
 {
 	TSG_LOG_DEBUG( "SceneGraph::__deprecated_update()" );
 	rootNode_->__deprecated_update();
+
+	// The walk recomputed every node it invalidated on the way down, so
+	// those entries must not pile up on the dirty list between updates
+	transforms_.pruneDirty();
+
+	notifyPluginData();
+}
+
+void SceneGraph::notifyPluginData()
+{
+	PluginDataMap::iterator iter = pluginData_.begin();
+	for (; iter != pluginData_.end(); ++iter)
+	{
+		iter->second->notifyUpdated();
+	}
+}
+
+void SceneGraph::notifyTopologyChanged()
+{
+	transforms_.invalidateOrder();
+	updater_.invalidatePartition();
+}
+
+void SceneGraph::setNumThreads(unsigned int numThreads)
+{
+	if ( numThreads == 0 )
+	{
+		TSG_LOG_WARN( "A scene graph needs at least one update thread. Using 1 instead of 0." );
+		numThreads = 1;
+	}
+
+	// Never resize the pool underneath a running update
+	threadPool_.wait();
+	threadPool_.size_controller().resize(numThreads);
+	TSG_LOG_INFO( "Scene graph now using " << numThreads << " update threads." );
+}
+
+unsigned int SceneGraph::getNumThreads() const
+{
+	return (unsigned int)threadPool_.size();
 }
 
 SceneObject* SceneGraph::createObject(const ObjectInfo& info)
 {
-	if ( objects_.find( info.name ) != objects_.end() )
+	NameHandle handle = internName(info.name);
+	if ( objects_[handle] != NULL )
 	{
 		// Error, object already exists in map
 		TSG_LOG_ERROR( "The \"" << info.type
@@ -215,10 +308,13 @@ SceneObject* SceneGraph::createObject(const ObjectInfo& info)
 		return NULL;
 	}
 	SceneObject* object = static_cast<SceneObject*>(obj);
+	object->setContext(this);
 	object->init(info);
 
-	// Record object into the object tracking map
-	objects_[info.name] = object;
+	// Record object into the object tracking tables
+	objects_[handle] = object;
+	objectList_.push_back(object);
+	objectHandles_[object] = handle;
 
 	// Finally return the object
 	return object;
@@ -243,11 +339,11 @@ SceneObject* SceneGraph::createObject(const std::string& name, const std::string
 
 SceneObject* SceneGraph::getObject(const std::string& name) const
 {
-	ObjectMap::const_iterator iter = objects_.find(name);
+	NameHandle handle = names_.find(name);
 
-	if ( iter != objects_.end() )
+	if ( handle < objects_.size() && objects_[handle] != NULL )
 	{
-		return iter->second;
+		return objects_[handle];
 	} else {
 		TSG_LOG_ERROR( "The object named \"" << name
 						 << "\" could not be found. Was it ever created in the first place?");
@@ -255,15 +351,33 @@ SceneObject* SceneGraph::getObject(const std::string& name) const
 	}
 }
 
+SceneObject* SceneGraph::getObject(NameHandle handle) const
+{
+	if ( handle < objects_.size() && objects_[handle] != NULL )
+	{
+		return objects_[handle];
+	} else {
+		TSG_LOG_ERROR( "No object with handle " << handle << " exists in graph." );
+		return NULL;
+	}
+}
+
+NameHandle SceneGraph::getObjectHandle(const SceneObject* object) const
+{
+	ObjectHandleMap::const_iterator iter = objectHandles_.find(object);
+	if ( iter != objectHandles_.end() ) return iter->second;
+	return NameTable::InvalidHandle;
+}
+
 SceneGraph::SceneObjectIterator SceneGraph::getAllObjects()
 {
-	SceneGraph::SceneObjectIterator iter(objects_.begin(), objects_.end());
+	SceneGraph::SceneObjectIterator iter(objectList_.begin(), objectList_.end());
 	return iter;
 }
 
 unsigned int SceneGraph::getNumObjects() const
 {
-	return (unsigned int)objects_.size();
+	return (unsigned int)objectList_.size();
 }
 
 QueryArguments SceneGraph::executeQuery(const std::string& querytype)
@@ -275,28 +389,91 @@ QueryArguments SceneGraph::executeQuery(const std::string& querytype)
 
 void SceneGraph::executeQuery(const std::string& querytype, QueryArguments& args)
 {
-	QueryMap::iterator iter = queries_.find(querytype);
-	Query* query = NULL;
+	Query* query = getQuery(querytype);
+	if ( query == NULL ) return;
 
-	if ( iter == queries_.end() )
+	TSG_LOG_INFO( "Executing query: " << querytype );
+
+	query->execute(&args);
+}
+
+void SceneGraph::executeBatchQuery(const std::string& querytype, const std::vector<NameHandle>& nodes,
+								   const float* poses, unsigned int numConfigs, BatchQueryResults& results,
+								   const PropertyContainer& parameters)
+{
+	results.clear();
+
+	Query* query = getQuery(querytype);
+	if ( query == NULL ) return;
+
+	std::vector<SceneNode*> targets( nodes.size() );
+	for (unsigned int n = 0; n < nodes.size(); ++n)
+	{
+		targets[n] = getNode(nodes[n]);
+		if ( targets[n] == NULL ) return;
+	}
+
+	// Poses to put back once all configurations are done
+	std::vector<float> saved( 7 * nodes.size() );
+	for (unsigned int n = 0; n < nodes.size(); ++n)
 	{
-		TSG_LOG_INFO( "Could not find query " << querytype << ". Creating one." );
+		const Vector3& p = targets[n]->getPosition();
+		const Quaternion& q = targets[n]->getOrientation();
+		for (unsigned int i = 0; i < 3; ++i) saved[7*n + i] = (float)p[i];
+		for (unsigned int i = 0; i < 4; ++i) saved[7*n + 3 + i] = (float)q[i];
+	}
 
-		query = createQuery(querytype);
-		if ( query != NULL )
+	TSG_LOG_INFO( "Executing query " << querytype << " for " << numConfigs << " configurations." );
+
+	QueryArguments args;
+	args.parameters = parameters;
+	for (unsigned int k = 0; k < numConfigs; ++k)
+	{
+		const float* config = poses + 7 * nodes.size() * k;
+		for (unsigned int n = 0; n < nodes.size(); ++n)
 		{
-			query->init();
-			queries_[querytype] = query;
+			targets[n]->updatePose( config + 7*n, config + 7*n + 3 );
 		}
+		update();
+
+		args.resetResults();
+		query->execute(&args);
+		results.append(args, *this);
 	}
-	else
+
+	for (unsigned int n = 0; n < nodes.size(); ++n)
 	{
-		query = iter->second;
+		targets[n]->updatePose( &saved[7*n], &saved[7*n + 3] );
 	}
+	update();
+}
 
-	TSG_LOG_INFO( "Executing query: " << querytype );
+PluginData* SceneGraph::getPluginData(const std::string& key) const
+{
+	PluginDataMap::const_iterator iter = pluginData_.find(key);
+	return ( iter != pluginData_.end() ) ? iter->second.get() : NULL;
+}
 
-	query->execute(&args);
+void SceneGraph::setPluginData(const std::string& key, PluginData* data)
+{
+	pluginData_[key].reset(data);
+}
+
+Query* SceneGraph::getQuery(const std::string& type)
+{
+	QueryMap::iterator iter = queries_.find(type);
+	if ( iter != queries_.end() ) return iter->second;
+
+	TSG_LOG_INFO( "Could not find query " << type << ". Creating one." );
+
+	Query* query = createQuery(type);
+	if ( query != NULL )
+	{
+		query->setContext(this);
+		query->init();
+		queries_[type] = query;
+	}
+	return query;
 }
 
 Query* SceneGraph::createQuery(const std::string& type)
@@ -314,20 +491,46 @@ Query* SceneGraph::createQuery(const std::string& type)
 }
 
 
-void SceneLoader::save(const char* filename, SceneGraph& g)
+void SceneLoader::save(const char* filename, SceneGraph& g, SceneFormat format)
 {
-	OArchive ar(filename);
-	ar.init();
 	int version = 0;
-	ar.serialize(g, version);
+	if ( format == SF_BINARY )
+	{
+		BinaryArchive ar(filename, BinaryArchive::Output);
+		ar.init();
+		ar.serialize(g, version);
+	} else {
+		OArchive ar(filename);
+		ar.init();
+		ar.serialize(g, version);
+	}
 }
 
 void SceneLoader::load(const char* filename, SceneGraph& g)
 {
-	IArchive ar(filename);
-	ar.init();
 	int version = 0;
-	ar.serialize(g, version);
+	if ( getFormat(filename) == SF_BINARY )
+	{
+		BinaryArchive ar(filename, BinaryArchive::Input);
+		ar.init();
+		ar.serialize(g, version);
+	} else {
+		// Streams the file rather than building a DOM (see IArchive)
+		XmlStreamReader reader(filename);
+		reader.load(g, version);
+	}
+}
+
+SceneFormat SceneLoader::getFormat(const char* filename)
+{
+	return BinaryArchive::isBinaryFile(filename) ? SF_BINARY : SF_XML;
+}
+
+void SceneLoader::convert(const char* from, const char* to, SceneFormat format)
+{
+	SceneGraph scratch(1);
+	load(from, scratch);
+	save(to, scratch, format);
 }
 
 /*
@@ -27,29 +27,43 @@
 
 // Internal includes
 #include "SceneNode.h"
+#include "NameTable.h"
+#include "NodePool.h"
+#include "TransformStore.h"
+#include "UpdateEngine.h"
+#include "BatchQuery.h"
+#include "threadpool.hpp"
+#include <boost/shared_ptr.hpp>
 
 namespace tinysg
 {
 
-class SceneGraph
+class SceneGraph : public SceneContext
 {
+	friend class SceneNode;
+	friend class BatchQuery;
+
 #if defined( TSG_HAVE_LOG4CXX )
 	static log4cxx::LoggerPtr logger;
 #endif
 
 	static unsigned long NextGeneratedNameExt;
 
-	typedef std::map<std::string, SceneObject*> ObjectMap;
-	typedef std::map<std::string, SceneNode*> NodeMap;
+	typedef std::vector<SceneObject*> ObjectVector;
+	typedef std::vector<SceneNode*> NodeVector;
 	typedef std::map<std::string, Query*> QueryMap;
+	typedef std::map<const SceneObject*, NameHandle> ObjectHandleMap;
+	typedef std::map<std::string, boost::shared_ptr<PluginData> > PluginDataMap;
 public:
-	typedef MapIterator<ObjectMap> SceneObjectIterator;
+	typedef VectorIterator<ObjectVector> SceneObjectIterator;
 
-	SceneGraph();
+	explicit SceneGraph(unsigned int numThreads = DefaultNumThreads);
 	~SceneGraph();
 
 	// Name of world node
 	static const std::string World;
+	// Number of update threads used when none is specified
+	static const unsigned int DefaultNumThreads;
 	static int InvokeService(const char* serviceName, void* serviceParams);
 	static std::string generateName()
 	{
@@ -64,38 +78,110 @@ public:
 	SceneNode* createNode(const std::string& name);
 	void destroyAllNodes();
 	SceneNode* getNode(const std::string& name) const;
+	SceneNode* getNode(NameHandle handle) const;
+
+	// Name management. Handles of existing nodes and objects never change, so
+	// they can be looked up once and then used in place of the name.
+	NameHandle getHandle(const std::string& name) const;
+	const std::string& getName(NameHandle handle) const {return names_.getName(handle);}
 
 	// Scene management
 	void clearScene();
 	void update();
 	void __deprecated_update();
+	// Called by nodes when children are added or removed
+	void notifyTopologyChanged();
+	// Number of nodes visited and recomputed by the last update()
+	const UpdateStats& getUpdateStats() const {return updater_.getStats();}
+
+	// Thread management
+	void setNumThreads(unsigned int numThreads);
+	unsigned int getNumThreads() const;
 
 	// Object management
 	SceneObject* createObject(const ObjectInfo& info);
 	SceneObject* createObject(const std::string& name, const std::string& type);
 	SceneObject* createObject(const std::string& name, const std::string& type, const PropertyContainer& properties);
 	SceneObject* getObject(const std::string& name) const;
+	SceneObject* getObject(NameHandle handle) const;
+	// Handle of an object of this graph, InvalidHandle for others
+	NameHandle getObjectHandle(const SceneObject* object) const;
 	SceneGraph::SceneObjectIterator getAllObjects(void);
 	unsigned int getNumObjects() const;
 
-	// Query management
+	// Query management. The first form builds its results from scratch on
+	// every call. Queries run repeatedly should reuse one QueryArguments with
+	// the second, calling resetResults() in between, which keeps the memory
+	// of the result vectors.
 	QueryArguments executeQuery(const std::string& querytype);
 	void executeQuery(const std::string& querytype, QueryArguments& args);
+	// Runs querytype once for each of numConfigs configurations of nodes.
+	// poses holds numConfigs*nodes.size() poses, configuration after
+	// configuration and in the order of nodes. A pose is 7 floats relative to
+	// the parent node: position x, y, z then orientation quaternion w, x, y,
+	// z. The graph is updated before every run and the nodes are put back
+	// afterwards. BatchQuery spreads configurations over copies of a scene.
+	void executeBatchQuery(const std::string& querytype, const std::vector<NameHandle>& nodes,
+						   const float* poses, unsigned int numConfigs, BatchQueryResults& results,
+						   const PropertyContainer& parameters = PropertyContainer());
+
+	// Plugin state of this scene, see SceneContext
+	virtual PluginData* getPluginData(const std::string& key) const;
+	virtual void setPluginData(const std::string& key, PluginData* data);
 
 private:
 	Query* createQuery(const std::string& type);
-
+	// Query of the given type, created on first use. NULL if there is none.
+	Query* getQuery(const std::string& type);
+	NameHandle internName(const std::string& name);
+	// Tells the plugin data that an update has finished
+	void notifyPluginData();
+	SceneNode* findNode(const std::string& name) const;
+
+	// Plugin state may be used by objects and queries, so it is released
+	// last
+	PluginDataMap pluginData_;
+
+	// Worker threads used by update(). Lives as long as the graph so that
+	// threads are not created and joined on every frame.
+	boost::threadpool::pool threadPool_;
+	// Both must outlive the nodes, which release their slot and report the
+	// topology change while dying
+	TransformStore transforms_;
+	UpdateEngine updater_;
+
+	// Storage for every node but the world node
+	NodePool nodePool_;
 	SceneNodePtr rootNode_;
-	NodeMap nodes_;
-	ObjectMap objects_;
+
+	// Nodes and objects share one name table. Both vectors are indexed by
+	// handle and hold NULL where the name belongs to the other kind.
+	NameTable names_;
+	NodeVector nodes_;
+	ObjectVector objects_;
+	// Objects in creation order, for iteration
+	ObjectVector objectList_;
+	// Reverse of objects_, for turning query results back into handles
+	ObjectHandleMap objectHandles_;
 	QueryMap queries_;
 };
 
 
+enum SceneFormat
+{
+	SF_XML,
+	SF_BINARY
+};
+
 struct SceneLoader
 {
-	static void save(const char* filename, SceneGraph& g);
+	static void save(const char* filename, SceneGraph& g, SceneFormat format = SF_XML);
+	// Picks the format from the file's magic
 	static void load(const char* filename, SceneGraph& g);
+	static SceneFormat getFormat(const char* filename);
+	// Loads a scene into a scratch graph and saves it again in the requested
+	// format. Needs the plugins for every object type in the scene.
+	static void convert(const char* from, const char* to, SceneFormat format);
 };
 
 }
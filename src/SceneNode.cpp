@@ -51,11 +51,8 @@ SceneNode::SceneNode(const std::string name) :
 	graph(NULL),
 	parent(NULL),
 	mpPoseGenerator(NULL),
-	position( Vector3::ZERO ),
-	orientation( Quaternion::IDENTITY ),
-	derivedPosition( Vector3::ZERO ),
-	derivedOrientation( Quaternion::IDENTITY ),
-	areDerivedCoordinatesValid(true),
+	store(NULL),
+	slot(0),
 	id(name)
 {
 
@@ -68,6 +65,16 @@ SceneNode::~SceneNode()
 		mpPoseGenerator->detachNode(this);
 	}*/
 	removeAllChildren();
+	if ( store != NULL ) store->release(slot);
+}
+
+void SceneNode::setGraph(SceneGraph* g)
+{
+	// A node gets its slot in the transform store when it joins a graph. All
+	// pose accessors assume this has happened.
+	graph = g;
+	store = &g->transforms_;
+	slot = store->allocate(this);
 }
 
 SceneNode* SceneNode::createChild()
@@ -95,14 +102,15 @@ void SceneNode::addChild(SceneNode* child)
 		return;
 	}
 
-	if ( children.find( child->getName() ) != children.end())
+	if ( getChild( child->getName() ) != NULL )
 	{
 		TSG_LOG_WARN( "Node " << getName() << ": Can't add child " << child->getName() << ". Child with that name already exists!" );
 		return;
 	}
 
 	child->setParent(this);
-	children[child->getName()] = child;
+	children.push_back(child);
+	if ( graph != NULL ) graph->notifyTopologyChanged();
 	TSG_LOG_DEBUG( "Node " << getName() << ": Added child " << child->getName() );
 }
 
@@ -131,9 +139,9 @@ SceneNode* SceneNode::removeChild (SceneNode *child)
 //! Drops the named child from this node.
 SceneNode* SceneNode::removeChild (const std::string &name)
 {
-	ChildrenMap::iterator i = children.find(name);
+	SceneNode* ret = getChild(name);
 
-	if (i == children.end())
+	if (ret == NULL)
 	{
 		TSG_LOG_WARN( "Node " << getName() << ": Can't remove child " << name << " because thats 'no baby of mine'." );
 		return NULL;
@@ -141,35 +149,41 @@ SceneNode* SceneNode::removeChild (const std::string &name)
 
 	TSG_LOG_DEBUG( "Node " << getName() << ": Removing child " << name << "." );
 
-	SceneNode* ret = i->second;
-	children.erase(i);
+	children.erase( std::find(children.begin(), children.end(), ret) );
 	ret->setParent(NULL);
+	if ( graph != NULL ) graph->notifyTopologyChanged();
 
 	return ret;
 }
 
 void SceneNode::removeAllChildren()
 {
-	std::pair<std::string, SceneNode*> pair;
-	BOOST_FOREACH(pair, children)
+	SceneNode* child = NULL;
+	BOOST_FOREACH(child, children)
 	{
-		SceneNode* child = static_cast<SceneNode*>(pair.second);
 		child->setParent(NULL);
 	}
 	children.clear();
+	if ( graph != NULL ) graph->notifyTopologyChanged();
 }
 
 //! Gets a pointer to a named child node.
 SceneNode* SceneNode::getChild (const std::string& name) const
 {
-	ChildrenMap::const_iterator i = children.find(name);
+	if ( graph != NULL )
+	{
+		// Hashed lookup in the graph, then make sure the node really is ours
+		SceneNode* node = graph->findNode(name);
+		return ( node != NULL && node->parent == this ) ? node : NULL;
+	}
 
-	if (i == children.end())
+	SceneNode* child = NULL;
+	BOOST_FOREACH(child, children)
 	{
-		//SML_EXCEPT(Exception::ERR_ITEM_NOT_FOUND, "Child node named " + name + " does not exist.");
-		return NULL;
+		if ( child->getName() == name ) return child;
 	}
-	return i->second;
+	//SML_EXCEPT(Exception::ERR_ITEM_NOT_FOUND, "Child node named " + name + " does not exist.");
+	return NULL;
 }
 
 SceneNode::ChildIterator SceneNode::getChildren()
@@ -190,6 +204,9 @@ void SceneNode::setParent(SceneNode* n)
 		TSG_LOG_DEBUG( "Node " << getName() << ": Parent was set to null. I have been orphaned!" );
 		parent = NULL;
 	}
+
+	// The local pose is kept, but it is now relative to someone else
+	if ( store != NULL ) store->invalidate(slot);
 }
 
 void SceneNode::updatePose( const float* translation, const float* rotation )
@@ -200,59 +217,66 @@ void SceneNode::updatePose( const float* translation, const float* rotation )
 
 void SceneNode::setPosition( const Vector3& p )
 {
+	requireStore();
 	TSG_LOG_DEBUG( "Node " << getName() << ": Setting position: (" << p[0] << ", " << p[1] << ", " << p[2] << ")" );
-	position = p;
+	store->localPosition_[slot] = p;
 	invalidate();
 }
 
 void SceneNode::setOrientation( const Quaternion& q )
 {
+	requireStore();
 	TSG_LOG_DEBUG( "Node " << getName() << ": Setting orientation: (" << q[0] << ", " << q[1] << ", " << q[2] << ", " << q[3] << ")" );
-	orientation = q;
+	store->localOrientation_[slot] = q;
 	invalidate();
 }
 
 const Vector3& SceneNode::getPosition(TransformSpace relativeTo) const
 {
+	requireStore();
 	switch ( relativeTo )
 	{
 	case TS_LOCAL:
 		return Vector3::ZERO;
 	case TS_PARENT:
-		return position;
+		return store->localPosition_[slot];
 	case TS_WORLD:
-		return derivedPosition;
+		return store->worldPosition_[slot];
 	}
-	return position;
+	return store->localPosition_[slot];
 }
 
 const Quaternion& SceneNode::getOrientation(TransformSpace relativeTo) const
 {
+	requireStore();
 	switch ( relativeTo )
 	{
 	case TS_LOCAL:
 		return Quaternion::IDENTITY;
 	case TS_PARENT:
-		return orientation;
+		return store->localOrientation_[slot];
 	case TS_WORLD:
-		return derivedOrientation;
+		return store->worldOrientation_[slot];
 	}
-	return orientation;
+	return store->localOrientation_[slot];
 }
 
 void SceneNode::invalidate()
 {
-	// Lock this object down.
-	//boost::mutex::scoped_lock lock(mWriteMutex);
-
-	areDerivedCoordinatesValid = false;
+	requireStore();
+	store->invalidate(slot);
 }
 
 void SceneNode::__deprecated_update()
 {
 	TSG_LOG_DEBUG( "__deprecated_update() entered for " << getName() );
 
-	if ( !areDerivedCoordinatesValid )
+	const Vector3& position = store->localPosition_[slot];
+	const Quaternion& orientation = store->localOrientation_[slot];
+	Vector3& derivedPosition = store->worldPosition_[slot];
+	Quaternion& derivedOrientation = store->worldOrientation_[slot];
+
+	if ( !store->valid_[slot] )
 	{
 		if ( hasParent()  )
 		{
@@ -277,7 +301,7 @@ void SceneNode::__deprecated_update()
 			derivedPosition = position;
 		}
 
-		areDerivedCoordinatesValid = true;
+		store->valid_[slot] = 1;
 		TSG_LOG_DEBUG( "Node " << getName() << ": Derived pose now valid." );
 
 		std::stringstream matrixmsg;
@@ -297,97 +321,41 @@ void SceneNode::__deprecated_update()
 		TSG_LOG_DEBUG( "Node " << getName() << ": All objects notified." );
 
 		TSG_LOG_DEBUG( "Node " << getName() << ": Invalidating pose of " << children.size() << " children." );
-		std::pair<std::string, SceneNode*> pair;
-		BOOST_FOREACH(pair, children)
+		SceneNode* child = NULL;
+		BOOST_FOREACH(child, children)
 		{
-			SceneNode* child = static_cast<SceneNode*>(pair.second);
 			child->invalidate();
 		}
 		TSG_LOG_DEBUG( "Node " << getName() << ": All child poses invalidated." );
 	}
 
 	TSG_LOG_DEBUG( "Node " << getName() << ": Calling update() for " << children.size() << " children." );
-	std::pair<std::string, SceneNode*> pair;
-	BOOST_FOREACH(pair, children)
+	SceneNode* child = NULL;
+	BOOST_FOREACH(child, children)
 	{
-		SceneNode* child = static_cast<SceneNode*>(pair.second);
 		child->__deprecated_update();
 	}
 	TSG_LOG_DEBUG( "Node " << getName() << ": Update complete." );
 }
 
-void SceneNode::update(boost::threadpool::pool& tp, bool forceUpdate)
-{
-	TSG_LOG_DEBUG( "update() entered for " << getName() );
-
-	bool scheduleAnUpdate = (!areDerivedCoordinatesValid || forceUpdate);
-
-	if ( scheduleAnUpdate )
-	{
-		// Schedule self for update
-		TSG_LOG_DEBUG( "Node " << getName() << ": Scheduling self for update." );
-		boost::threadpool::schedule(tp, boost::bind(&SceneNode::doUpdate, this));
-	}
-
-	TSG_LOG_DEBUG( "Node " << getName() << ": Calling update() of " << children.size() << " children." );
-	std::pair<std::string, SceneNode*> pair;
-	BOOST_FOREACH(pair, children)
-	{
-		SceneNode* child = static_cast<SceneNode*>(pair.second);
-		child->update(tp, scheduleAnUpdate);
-	}
-	TSG_LOG_DEBUG( "Node " << getName() << ": All child poses invalidated." );
-}
-
-void SceneNode::doUpdate()
+void SceneNode::notifyAttachedObjects()
 {
-	// Lock this object down.
-	//boost::mutex::scoped_lock lock(mWriteMutex);
-
-	TSG_LOG_DEBUG( "Node " << getName() << ": Doing my update." );
-	if ( hasParent()  )
-	{
-		TSG_LOG_DEBUG( "Node " << getName() << ": Derived pose invalid. Recalculating from parent." );
-
-		// Get parent orientation
-		Quaternion q_parent = getParent()->getOrientation(TS_WORLD);
-		Vector3 p_parent = getParent()->getPosition(TS_WORLD);
-
-		// Update derived orientation
-		derivedOrientation = q_parent * orientation;
-
-		// Update derived position
-		derivedPosition = q_parent * position + p_parent;
-	}
-	else
-	{
-		TSG_LOG_DEBUG( "Node " << getName() << ": Derived pose invalid. Recalculating from self (no parent)." );
-
-		// Root node, no parent
-		derivedOrientation = orientation;
-		derivedPosition = position;
-	}
-
-	areDerivedCoordinatesValid = true;
-	TSG_LOG_DEBUG( "Node " << getName() << ": Derived pose now valid." );
-
 	TSG_LOG_DEBUG( "Node " << getName() << ": Notifying " << attachedObjects.size() << " objects." );
 	SceneObject* object=NULL;
 	BOOST_FOREACH(object, attachedObjects)
 	{
-		// TODO: Threadpool this?
-		object->notifyMoved(derivedPosition.ptr(), derivedOrientation.ptr());
+		object->notifyMoved(store->worldPosition_[slot].ptr(), store->worldOrientation_[slot].ptr());
 	}
-	TSG_LOG_DEBUG( "Node " << getName() << ": All objects notified." );
 }
 
 void SceneNode::attach(SceneObject* obj)
 {
+	requireStore();
 	// Add obj to the node's list of attached objects
 	attachedObjects.push_back(obj);
 
 	// Then notify the obj that it needs to update its spatial coordinates
-	obj->notifyMoved(derivedPosition.ptr(), derivedOrientation.ptr());
+	obj->notifyMoved(store->worldPosition_[slot].ptr(), store->worldOrientation_[slot].ptr());
 }
 
 SceneObjectIterator SceneNode::getAttachedObjects()
@@ -33,9 +33,9 @@ using namespace obrsp::linalg;
 
 #include "threadpool.hpp"
 #include <boost/foreach.hpp>
-#include <boost/thread/mutex.hpp>
 
 #include <Visitor.h>
+#include "TransformStore.h"
 
 namespace tinysg
 {
@@ -56,6 +56,8 @@ enum TransformSpace
 class SceneNode : public Node
 {
 	friend class SceneGraph;
+	friend class UpdateEngine;
+	friend class TransformStore;
 
 #if defined( TSG_HAVE_LOG4CXX )
 	static log4cxx::LoggerPtr logger;
@@ -65,8 +67,8 @@ class SceneNode : public Node
 public:
 	static std::string generateName();
 
-	typedef std::map<std::string, SceneNode*> ChildrenMap;
-	typedef MapIterator<ChildrenMap> ChildIterator;
+	typedef std::vector<SceneNode*> ChildrenVector;
+	typedef VectorIterator<ChildrenVector> ChildIterator;
 
 	typedef std::vector<SceneObject*> SceneObjectVector;
 	typedef VectorIterator<SceneObjectVector> SceneObjectIterator;
@@ -92,6 +94,8 @@ public:
 
 	const std::string& getName() const {return id;}
 
+	// Only for nodes created by a SceneGraph; others throw. The references
+	// returned are invalidated by the next createNode() or update().
 	void setPosition( const Vector3& p );
 	void setOrientation( const obrsp::linalg::Quaternion& q );
 	const Vector3& getPosition(TransformSpace space=TS_PARENT) const;
@@ -99,8 +103,6 @@ public:
 
 	void invalidate();
 	void __deprecated_update();
-	void update(boost::threadpool::pool& tp, bool forceUpdate = false);
-	void doUpdate();
 
 	// Object functions
 	void attach(SceneObject* obj);
@@ -116,26 +118,29 @@ public:
 
 protected:
 	void setParent(SceneNode* n);
-	void setGraph(SceneGraph* g) {graph = g;};
+	void setGraph(SceneGraph* g);
 
 private:
 	//void notifyChild(SceneNode* child);
+	void notifyAttachedObjects();
+
 	SceneGraph* graph;
 	SceneNode* parent;
-	ChildrenMap children;
+	// Name lookups go through the graph's name table, so a plain vector will do
+	ChildrenVector children;
 	SceneObjectVector attachedObjects;
 	PoseGenerator* mpPoseGenerator;
 
-	Vector3 position;
-	obrsp::linalg::Quaternion orientation;
-	mutable Vector3 derivedPosition;
-	mutable obrsp::linalg::Quaternion derivedOrientation;
-
-	mutable bool areDerivedCoordinatesValid;
+	// Poses live in the graph's transform store; this is our slot in it.
+	TransformStore* store;
+	unsigned int slot;
+	// Throws for a node that has not joined a graph and so has no slot yet
+	void requireStore() const
+	{
+		if ( store == NULL ) throw std::string("Node " + id + " does not belong to a scene graph, so it has no pose.");
+	}
 
 	std::string id;
-
-	boost::mutex mWriteMutex;
 };
 
 
@@ -0,0 +1,187 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * TransformStore.cpp
+ *
+ *  Created on: Mar 9, 2009
+ *      Author: yamokosk
+ */
+
+#include "TransformStore.h"
+#include "SceneNode.h"
+
+#include <boost/static_assert.hpp>
+
+// The pose kernels treat the pose arrays as packed floats
+BOOST_STATIC_ASSERT( sizeof(obrsp::linalg::Vector3) == 3 * sizeof(float) );
+BOOST_STATIC_ASSERT( sizeof(obrsp::linalg::Quaternion) == 4 * sizeof(float) );
+
+namespace tinysg
+{
+
+TransformStore::TransformStore() :
+	treeSize_(0),
+	sorted_(true),
+	kernel_( best_pose_kernel() )
+{
+
+}
+
+unsigned int TransformStore::allocate(SceneNode* node)
+{
+	unsigned int slot = (unsigned int)nodes_.size();
+
+	nodes_.push_back(node);
+	parent_.push_back(-1);
+	childBegin_.push_back(0);
+	childEnd_.push_back(0);
+	localPosition_.push_back( Vector3::ZERO );
+	localOrientation_.push_back( Quaternion::IDENTITY );
+	worldPosition_.push_back( Vector3::ZERO );
+	worldOrientation_.push_back( Quaternion::IDENTITY );
+	valid_.push_back(1);
+	changed_.push_back(0);
+
+	sorted_ = false;
+	return slot;
+}
+
+void TransformStore::release(unsigned int slot)
+{
+	// The slot is reclaimed the next time the store is sorted
+	nodes_[slot] = NULL;
+	sorted_ = false;
+}
+
+void TransformStore::deriveRange(unsigned int first, unsigned int last)
+{
+	// Roots have no parent to compose with
+	while ( first < last && parent_[first] < 0 ) derive(first++);
+	if ( first == last ) return;
+
+	compose_poses(kernel_, first, last, &parent_[0],
+				  localPosition_[0].ptr(), localOrientation_[0].ptr(),
+				  worldPosition_[0].ptr(), worldOrientation_[0].ptr());
+
+	for (unsigned int n = first; n < last; ++n) valid_[n] = 1;
+}
+
+void TransformStore::clear()
+{
+	nodes_.clear();
+	parent_.clear();
+	childBegin_.clear();
+	childEnd_.clear();
+	localPosition_.clear();
+	localOrientation_.clear();
+	worldPosition_.clear();
+	worldOrientation_.clear();
+	valid_.clear();
+	changed_.clear();
+	dirty_.clear();
+
+	treeSize_ = 0;
+	sorted_ = true;
+}
+
+void TransformStore::sort(SceneNode* root)
+{
+	std::vector<unsigned int> order;
+	std::vector<char> visited(nodes_.size(), 0);
+	order.reserve(nodes_.size());
+	parent_.clear();
+	childBegin_.clear();
+	childEnd_.clear();
+
+	// World tree first...
+	appendTree(root->slot, order, visited);
+	treeSize_ = (unsigned int)order.size();
+
+	// ...followed by any detached subtrees. Released slots are dropped here.
+	for (unsigned int slot = 0; slot < nodes_.size(); ++slot)
+	{
+		if ( nodes_[slot] != NULL && !visited[slot] && !nodes_[slot]->hasParent() )
+		{
+			appendTree(slot, order, visited);
+		}
+	}
+
+	permute(nodes_, order);
+	permute(localPosition_, order);
+	permute(localOrientation_, order);
+	permute(worldPosition_, order);
+	permute(worldOrientation_, order);
+	permute(valid_, order);
+	changed_.assign(order.size(), 0);
+
+	for (unsigned int slot = 0; slot < nodes_.size(); ++slot)
+	{
+		nodes_[slot]->slot = slot;
+	}
+
+	// Carry the dirty list over to the new slot numbers, dropping released
+	// slots along the way
+	std::vector<int> newSlot(visited.size(), -1);
+	for (unsigned int n = 0; n < order.size(); ++n) newSlot[ order[n] ] = (int)n;
+
+	std::vector<unsigned int> dirty;
+	BOOST_FOREACH(unsigned int slot, dirty_)
+	{
+		if ( newSlot[slot] >= 0 ) dirty.push_back( (unsigned int)newSlot[slot] );
+	}
+	dirty_.swap(dirty);
+
+	sorted_ = true;
+}
+
+void TransformStore::pruneDirty()
+{
+	unsigned int kept = 0;
+	BOOST_FOREACH(unsigned int slot, dirty_)
+	{
+		if ( !valid_[slot] ) dirty_[kept++] = slot;
+	}
+	dirty_.resize(kept);
+}
+
+void TransformStore::appendTree(unsigned int rootSlot, std::vector<unsigned int>& order, std::vector<char>& visited)
+{
+	// Breadth first. Parent and child ranges are written in terms of the new
+	// (sorted) slot numbers, which are simply positions in order.
+	unsigned int head = (unsigned int)order.size();
+	order.push_back(rootSlot);
+	parent_.push_back(-1);
+	visited[rootSlot] = 1;
+
+	for (; head < order.size(); ++head)
+	{
+		SceneNode* node = nodes_[ order[head] ];
+		childBegin_.push_back( (unsigned int)order.size() );
+
+		SceneNode* child = NULL;
+		BOOST_FOREACH(child, node->children)
+		{
+			order.push_back(child->slot);
+			parent_.push_back( (int)head );
+			visited[child->slot] = 1;
+		}
+		childEnd_.push_back( (unsigned int)order.size() );
+	}
+}
+
+}
@@ -0,0 +1,157 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * TransformStore.h
+ *
+ *  Created on: Mar 9, 2009
+ *      Author: yamokosk
+ */
+
+#ifndef _TINYSG_TRANSFORM_STORE_H_FILE_
+#define _TINYSG_TRANSFORM_STORE_H_FILE_
+
+#include "config.h"
+
+#include <vector>
+
+#include <linalg/Vector3.h>
+#include <linalg/Quaternion.h>
+
+#include "PoseKernel.h"
+
+namespace tinysg
+{
+
+// Forward declaration
+class SceneNode;
+
+/*
+ * Holds the poses of every node in a SceneGraph as parallel arrays. A
+ * SceneNode only keeps its slot index into these arrays.
+ *
+ * Slots are handed out in creation order. Whenever the topology changes the
+ * store is re-sorted breadth first from the world node, so that
+ *
+ *   - a parent always sits before its children (parent_[i] < i),
+ *   - the children of slot i occupy [childBegin_[i], childEnd_[i]),
+ *   - the descendants of a node on any one level form a contiguous range.
+ *
+ * The world tree occupies [0, getTreeSize()). Nodes that are not connected to
+ * the world node follow it and are never updated, just as before.
+ *
+ * References handed out by SceneNode's pose accessors point into these
+ * arrays. Creating any node of the graph may reallocate them, and sorting
+ * after a topology change moves nodes to new slots, so a reference is only
+ * good until the next createNode() or update(). Copy the pose to keep it.
+ */
+class TransformStore
+{
+	friend class SceneNode;
+	friend class UpdateEngine;
+
+public:
+	TransformStore();
+
+	unsigned int allocate(SceneNode* node);
+	void release(unsigned int slot);
+	void clear();
+
+	void invalidateOrder() {sorted_ = false;}
+	bool isSorted() const {return sorted_;}
+	void sort(SceneNode* root);
+	// Drops the slots that are valid again from the dirty list
+	void pruneDirty();
+
+	unsigned int size() const {return (unsigned int)nodes_.size();}
+	unsigned int getTreeSize() const {return treeSize_;}
+	unsigned int getNumDirty() const {return (unsigned int)dirty_.size();}
+
+	void invalidate(unsigned int i)
+	{
+		// Only the first invalidation since the last update goes on the list
+		if ( valid_[i] )
+		{
+			valid_[i] = 0;
+			dirty_.push_back(i);
+		}
+	}
+
+	// Recomputes the world pose of slot i from its parent's. Same arithmetic
+	// as SceneNode::__deprecated_update() so both give identical results.
+	void derive(unsigned int i)
+	{
+		int p = parent_[i];
+		if ( p >= 0 )
+		{
+			const obrsp::linalg::Quaternion& q_parent = worldOrientation_[p];
+			worldOrientation_[i] = q_parent * localOrientation_[i];
+			worldPosition_[i] = q_parent * localPosition_[i] + worldPosition_[p];
+		}
+		else
+		{
+			worldOrientation_[i] = localOrientation_[i];
+			worldPosition_[i] = localPosition_[i];
+		}
+		valid_[i] = 1;
+	}
+
+	// Recomputes slots [first, last) in one batch with the SIMD kernel. All
+	// parents must lie outside the range.
+	void deriveRange(unsigned int first, unsigned int last);
+
+	PoseKernelType getPoseKernel() const {return kernel_;}
+	void setPoseKernel(PoseKernelType type) {kernel_ = type;}
+
+private:
+	void appendTree(unsigned int rootSlot, std::vector<unsigned int>& order, std::vector<char>& visited);
+
+	template <class T>
+	static void permute(std::vector<T>& v, const std::vector<unsigned int>& order)
+	{
+		std::vector<T> sorted;
+		sorted.reserve(order.size());
+		for (unsigned int n = 0; n < order.size(); ++n) sorted.push_back( v[order[n]] );
+		v.swap(sorted);
+	}
+
+	std::vector<SceneNode*> nodes_;
+	std::vector<int> parent_;
+	std::vector<unsigned int> childBegin_;
+	std::vector<unsigned int> childEnd_;
+
+	std::vector<obrsp::linalg::Vector3> localPosition_;
+	std::vector<obrsp::linalg::Quaternion> localOrientation_;
+	std::vector<obrsp::linalg::Vector3> worldPosition_;
+	std::vector<obrsp::linalg::Quaternion> worldOrientation_;
+
+	// Non-zero when the world pose is up to date with the local one
+	std::vector<char> valid_;
+	// Scratch used by the update engine: non-zero if the slot was recomputed
+	// during the current update
+	std::vector<char> changed_;
+	// Slots invalidated since the last update
+	std::vector<unsigned int> dirty_;
+
+	unsigned int treeSize_;
+	bool sorted_;
+	PoseKernelType kernel_;
+};
+
+}
+
+#endif
@@ -0,0 +1,276 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * UpdateEngine.cpp
+ *
+ *  Created on: Mar 2, 2009
+ *      Author: yamokosk
+ */
+
+#include "UpdateEngine.h"
+#include "TransformStore.h"
+#include "SceneNode.h"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+
+namespace tinysg
+{
+
+#if defined( TSG_HAVE_LOG4CXX )
+log4cxx::LoggerPtr UpdateEngine::logger( log4cxx::Logger::getLogger("TinySG.UpdateEngine") );
+#endif
+
+const unsigned int UpdateEngine::MinGrainSize(64);
+const unsigned int UpdateEngine::TasksPerWorker(8);
+
+UpdateEngine::UpdateEngine() :
+	partitionValid_(false)
+{
+	stats_.visited = 0;
+	stats_.recomputed = 0;
+
+}
+
+void UpdateEngine::update(TransformStore& store, boost::threadpool::pool& tp)
+{
+	unsigned int numWorkers = std::max<unsigned int>( (unsigned int)tp.size(), 1 );
+	if ( !partitionValid_ || queues_.size() != numWorkers )
+	{
+		partition(store, numWorkers);
+	}
+
+	stats_.visited = 0;
+	stats_.recomputed = 0;
+
+	// Walk the spine serially. The spine is stored parent first, so a parent
+	// has always been updated by the time its children are looked at.
+	BOOST_FOREACH(unsigned int slot, spine_)
+	{
+		stats_.recomputed += updateRange(store, slot, slot + 1);
+	}
+	stats_.visited += (unsigned int)spine_.size();
+
+	// Subtrees below a recomputed spine node must be redone in full...
+	unsigned int numTasks = 0;
+	BOOST_FOREACH(unsigned int root, taskRoots_)
+	{
+		int parent = store.parent_[root];
+		if ( parent >= 0 && store.changed_[parent] )
+		{
+			queues_[numTasks++ % numWorkers]->tasks.push_back(root);
+		}
+	}
+
+	// ...and so must the subtree of every dirty node that none of the above
+	// (or another dirty node) already covers. All of this is decided before
+	// any worker starts, while the valid flags still say what is dirty. A
+	// node invalidated again after __deprecated_update() can be listed twice.
+	std::vector<unsigned int>& dirty = store.dirty_;
+	std::sort(dirty.begin(), dirty.end());
+	dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+	BOOST_FOREACH(unsigned int slot, dirty)
+	{
+		if ( slot >= store.getTreeSize() || store.valid_[slot] ) continue;
+		if ( onSpine_[slot] || isCovered(store, slot) ) continue;
+		queues_[numTasks++ % numWorkers]->tasks.push_back(slot);
+	}
+
+	if ( numTasks == 1 )
+	{
+		// Not worth waking the pool for
+		unsigned int root = queues_[0]->tasks.back();
+		queues_[0]->tasks.pop_back();
+		updateSubtree(store, root, stats_);
+	}
+	else if ( numTasks > 1 )
+	{
+		// Workers only start once all tasks are queued, so no new work can
+		// show up after a worker gives up.
+		for (unsigned int n = 0; n < numWorkers; ++n)
+		{
+			queues_[n]->stats.visited = 0;
+			queues_[n]->stats.recomputed = 0;
+			boost::threadpool::schedule(tp, boost::bind(&UpdateEngine::runWorker, this, &store, n));
+		}
+		tp.wait();
+
+		BOOST_FOREACH(TaskQueuePtr queue, queues_)
+		{
+			stats_.visited += queue->stats.visited;
+			stats_.recomputed += queue->stats.recomputed;
+		}
+	}
+
+	// Whatever is still invalid lives outside the world tree. Keep it on the
+	// list for when it gets attached.
+	store.pruneDirty();
+
+	TSG_LOG_DEBUG( "Update visited " << stats_.visited << " nodes and recomputed " << stats_.recomputed << "." );
+}
+
+bool UpdateEngine::isCovered(const TransformStore& store, unsigned int slot) const
+{
+	// Climb to the root of the task holding this slot. An invalid node on the
+	// way will take this one along, as will a recomputed spine node above
+	// the task root.
+	unsigned int node = slot;
+	int parent = store.parent_[node];
+	while ( parent >= 0 && !onSpine_[parent] )
+	{
+		node = (unsigned int)parent;
+		if ( !store.valid_[node] ) return true;
+		parent = store.parent_[node];
+	}
+	return ( parent >= 0 && store.changed_[parent] );
+}
+
+void UpdateEngine::partition(const TransformStore& store, unsigned int numWorkers)
+{
+	unsigned int numNodes = store.getTreeSize();
+	unsigned int grainSize = std::max(MinGrainSize, numNodes / (numWorkers * TasksPerWorker));
+
+	// Children always come after their parent, so one backwards pass adds
+	// every subtree up.
+	std::vector<unsigned int> subtreeSize(numNodes, 1);
+	for (unsigned int n = numNodes; n-- > 1; )
+	{
+		subtreeSize[ store.parent_[n] ] += subtreeSize[n];
+	}
+
+	// A node hanging off the spine (or the root itself) either joins the
+	// spine or becomes a task, depending on the size of its subtree.
+	onSpine_.assign(numNodes, 0);
+	spine_.clear();
+	taskRoots_.clear();
+	for (unsigned int n = 0; n < numNodes; ++n)
+	{
+		int parent = store.parent_[n];
+		if ( parent >= 0 && !onSpine_[parent] ) continue;
+
+		if ( subtreeSize[n] > grainSize )
+		{
+			onSpine_[n] = 1;
+			spine_.push_back(n);
+		} else {
+			taskRoots_.push_back(n);
+		}
+	}
+
+	queues_.clear();
+	for (unsigned int n = 0; n < numWorkers; ++n)
+	{
+		queues_.push_back( TaskQueuePtr(new TaskQueue) );
+	}
+
+	partitionValid_ = true;
+	TSG_LOG_DEBUG( "Partitioned " << numNodes << " nodes into a spine of " << spine_.size()
+					<< " nodes and " << taskRoots_.size() << " subtree tasks (grain size "
+					<< grainSize << ", " << numWorkers << " workers)." );
+}
+
+void UpdateEngine::runWorker(TransformStore* store, unsigned int id)
+{
+	unsigned int root = 0;
+	while ( popTask(id, root) )
+	{
+		updateSubtree(*store, root, queues_[id]->stats);
+	}
+}
+
+bool UpdateEngine::popTask(unsigned int id, unsigned int& task)
+{
+	// Work from the back of our own queue...
+	{
+		TaskQueue& own = *queues_[id];
+		boost::mutex::scoped_lock lock(own.mutex);
+		if ( !own.tasks.empty() )
+		{
+			task = own.tasks.back();
+			own.tasks.pop_back();
+			return true;
+		}
+	}
+
+	// ...and steal from the front of everybody else's.
+	for (unsigned int n = 1; n < queues_.size(); ++n)
+	{
+		TaskQueue& victim = *queues_[(id + n) % queues_.size()];
+		boost::mutex::scoped_lock lock(victim.mutex);
+		if ( !victim.tasks.empty() )
+		{
+			task = victim.tasks.front();
+			victim.tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+unsigned int UpdateEngine::updateRange(TransformStore& store, unsigned int first, unsigned int last)
+{
+	// Same rule as SceneNode::__deprecated_update(): a node is recomputed if
+	// it was invalidated or if its parent was just recomputed.
+	for (unsigned int n = first; n < last; ++n)
+	{
+		int parent = store.parent_[n];
+		store.changed_[n] = ( !store.valid_[n] || (parent >= 0 && store.changed_[parent]) );
+	}
+
+	// Hand each run of changed slots to the pose kernel in one go. Parents
+	// live on the previous level, so they are never part of the run.
+	unsigned int recomputed = 0;
+	unsigned int n = first;
+	while ( n < last )
+	{
+		if ( !store.changed_[n] ) { ++n; continue; }
+
+		unsigned int end = n + 1;
+		while ( end < last && store.changed_[end] ) ++end;
+		store.deriveRange(n, end);
+		recomputed += end - n;
+		n = end;
+	}
+
+	for (n = first; n < last; ++n)
+	{
+		if ( store.changed_[n] && !store.nodes_[n]->attachedObjects.empty() )
+		{
+			store.nodes_[n]->notifyAttachedObjects();
+		}
+	}
+	return recomputed;
+}
+
+void UpdateEngine::updateSubtree(TransformStore& store, unsigned int root, UpdateStats& stats)
+{
+	// Descendants of a node on the same level are contiguous in the store,
+	// and so are their children.
+	unsigned int first = root, last = root + 1;
+	while ( first < last )
+	{
+		stats.visited += last - first;
+		stats.recomputed += updateRange(store, first, last);
+
+		unsigned int next = store.childBegin_[first];
+		last = store.childEnd_[last - 1];
+		first = next;
+	}
+}
+
+}
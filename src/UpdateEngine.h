@@ -0,0 +1,123 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * UpdateEngine.h
+ *
+ *  Created on: Mar 2, 2009
+ *      Author: yamokosk
+ */
+
+#ifndef _TINYSG_UPDATE_ENGINE_H_FILE_
+#define _TINYSG_UPDATE_ENGINE_H_FILE_
+
+#include "config.h"
+
+#include <vector>
+#include <deque>
+
+#include "threadpool.hpp"
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace tinysg
+{
+
+// Forward declaration
+class TransformStore;
+
+//! What the last SceneGraph::update() did.
+struct UpdateStats
+{
+	//! Nodes whose state was looked at
+	unsigned int visited;
+	//! Nodes whose world pose was recomputed
+	unsigned int recomputed;
+};
+
+/*
+ * Propagates world poses down the scene graph with a thread pool.
+ *
+ * The tree is cut in two. Nodes whose subtree holds more than the grain size
+ * form the "spine" and are updated serially, parents before children. Every
+ * subtree hanging off the spine becomes one task. Since the transform store
+ * is sorted breadth first, a task walks its subtree one contiguous level at a
+ * time, so a child is never computed before its parent. Each worker owns a
+ * deque of tasks and steals from the other workers when its own deque runs
+ * dry.
+ *
+ * Only dirty subtrees are walked. Spine nodes are always checked, but below
+ * the spine a task is only queued for a subtree hanging off a recomputed
+ * spine node, or for a node on the store's dirty list that has no dirty
+ * ancestor. An update that moves nothing touches nothing but the spine.
+ *
+ * The partition is cached and only rebuilt after the topology changes or the
+ * number of workers changes.
+ */
+class UpdateEngine
+{
+#if defined( TSG_HAVE_LOG4CXX )
+	static log4cxx::LoggerPtr logger;
+#endif
+
+public:
+	// Smallest number of nodes worth turning into a task
+	static const unsigned int MinGrainSize;
+	// Number of subtree tasks to aim for per worker
+	static const unsigned int TasksPerWorker;
+
+	UpdateEngine();
+
+	void invalidatePartition() {partitionValid_ = false;}
+	void update(TransformStore& store, boost::threadpool::pool& tp);
+
+	const UpdateStats& getStats() const {return stats_;}
+
+private:
+	struct TaskQueue
+	{
+		boost::mutex mutex;
+		std::deque<unsigned int> tasks;
+		// Filled in by the worker that owns this queue
+		UpdateStats stats;
+	};
+	typedef boost::shared_ptr<TaskQueue> TaskQueuePtr;
+
+	void partition(const TransformStore& store, unsigned int numWorkers);
+	bool isCovered(const TransformStore& store, unsigned int slot) const;
+
+	void runWorker(TransformStore* store, unsigned int id);
+	bool popTask(unsigned int id, unsigned int& task);
+	static unsigned int updateRange(TransformStore& store, unsigned int first, unsigned int last);
+	static void updateSubtree(TransformStore& store, unsigned int root, UpdateStats& stats);
+
+	// Slots of the spine nodes, parents first
+	std::vector<unsigned int> spine_;
+	// Slots of the subtree task roots
+	std::vector<unsigned int> taskRoots_;
+	// Non-zero for slots on the spine
+	std::vector<char> onSpine_;
+
+	std::vector<TaskQueuePtr> queues_;
+	bool partitionValid_;
+
+	UpdateStats stats_;
+};
+
+}
+
+#endif
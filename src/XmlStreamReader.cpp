@@ -0,0 +1,527 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * XmlStreamReader.cpp
+ *
+ *  Created on: Apr 6, 2009
+ *      Author: yamokosk
+ */
+
+
+#include "XmlStreamReader.h"
+
+#include "Archive.h"
+#include "SceneGraph.h"
+#include "SceneNode.h"
+#include "Stringify.h"
+#include "NodeUtils.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <sstream>
+
+#include <linalg/Vector3.h>
+#include <linalg/Quaternion.h>
+#include <linalg/MathExpression.h>
+using namespace obrsp::linalg;
+
+namespace tinysg
+{
+
+const size_t XmlStreamReader::BufferSize(64 * 1024);
+
+#if defined( TSG_HAVE_LOG4CXX )
+log4cxx::LoggerPtr XmlStreamReader::logger( log4cxx::Logger::getLogger("TinySG.XmlStreamReader") );
+#endif
+
+const char* XmlStreamReader::Tag::attribute(const char* attr) const
+{
+	for (unsigned int n = 0; n < attributes.size(); ++n)
+	{
+		if ( attributes[n].first == attr ) return attributes[n].second.c_str();
+	}
+	return NULL;
+}
+
+XmlStreamReader::XmlStreamReader(const std::string& f) :
+	filename(f),
+	buffer_(BufferSize),
+	pos_(0),
+	end_(0),
+	line_(1),
+	graph_(NULL),
+	version_(NULL),
+	sawWorld_(false),
+	currNode_(NULL),
+	inObject_(false)
+{
+
+}
+
+void XmlStreamReader::load(SceneGraph& graph, int& ver)
+{
+	file_.open(filename.c_str(), std::ios::in | std::ios::binary);
+	if ( !file_ )
+	{
+		throw std::string("Could not open " + filename + ".");
+	}
+
+	graph_ = &graph;
+	version_ = &ver;
+	ver = 0;
+
+	Tag tag;
+	while ( nextTag(tag) )
+	{
+		if ( tag.closing )
+		{
+			if ( open_.empty() || open_.back() != tag.name )
+			{
+				error("Unexpected closing tag </" + tag.name + ">.");
+			}
+			endElement();
+			continue;
+		}
+
+		startElement(tag);
+		if ( tag.selfClosing ) endElement();
+	}
+
+	if ( !open_.empty() )
+	{
+		error("Element <" + open_.back() + "> is never closed.");
+	}
+	file_.close();
+}
+
+/*
+ * Element handlers. The nesting rules are the ones IArchive follows: nodes
+ * are children of the root, positions, orientations and objects are children
+ * of a node, properties are children of an object or of another property.
+ * Anything else is ignored.
+ */
+void XmlStreamReader::startElement(const Tag& tag)
+{
+	ElementKind parent = kinds_.empty() ? EK_IGNORED : kinds_.back();
+	ElementKind kind = EK_IGNORED;
+
+	if ( open_.empty() )
+	{
+		if ( tag.name != "TinySG" )
+		{
+			error("Root element is <" + tag.name + ">, not <TinySG>.");
+		}
+		const char* version = tag.attribute("version");
+		if ( version != NULL ) *version_ = std::atoi(version);
+		kind = EK_ROOT;
+	}
+	else if ( parent == EK_ROOT && tag.name == Archive::NodeTagName )
+	{
+		kind = startNode(tag);
+	}
+	else if ( parent == EK_NODE && tag.name == Archive::PositionTagName )
+	{
+		readPosition(tag);
+	}
+	else if ( parent == EK_NODE && tag.name == Archive::OrientationTagName )
+	{
+		readOrientation(tag);
+	}
+	else if ( parent == EK_NODE && tag.name == Archive::ObjectTagName )
+	{
+		kind = startObject(tag);
+	}
+	else if ( (parent == EK_OBJECT || parent == EK_PROPERTY) && tag.name == Archive::PropertyTagName )
+	{
+		kind = startProperty(tag);
+	}
+
+	open_.push_back(tag.name);
+	kinds_.push_back(kind);
+}
+
+void XmlStreamReader::endElement()
+{
+	ElementKind kind = kinds_.back();
+	open_.pop_back();
+	kinds_.pop_back();
+
+	switch ( kind )
+	{
+	case EK_NODE:
+		currNode_ = NULL;
+		break;
+	case EK_OBJECT:
+	{
+		inObject_ = false;
+		TSG_LOG_INFO( "Creating scene object \"" << info_.name << "\"." );
+		SceneObject* sceneObject = graph_->createObject(info_);
+		if ( sceneObject != NULL ) currNode_->attach(sceneObject);
+		break;
+	}
+	case EK_PROPERTY:
+	case EK_UNKNOWN_PROPERTY:
+	{
+		Property prop = properties_.back();
+		properties_.pop_back();
+		if ( properties_.empty() )
+		{
+			info_.addProperty(prop);
+		} else {
+			properties_.back().add_parameter(prop);
+		}
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+XmlStreamReader::ElementKind XmlStreamReader::startNode(const Tag& tag)
+{
+	const char* nodeName = tag.attribute("name");
+
+	if ( !sawWorld_ )
+	{
+		// The world node is created along with the graph
+		if ( nodeName == NULL || SceneGraph::World != nodeName )
+		{
+			throw std::string("World node was not the first node in the XML archive.");
+		}
+		sawWorld_ = true;
+		currNode_ = graph_->getNode(SceneGraph::World);
+	}
+	else if ( (nodeName == NULL) || (Archive::UnnamedValue == nodeName) )
+	{
+		currNode_ = graph_->createNode( SceneNode::generateName() );
+	} else {
+		currNode_ = graph_->createNode( std::string(nodeName) );
+	}
+
+	const char* parentName = tag.attribute("parent");
+	if ( parentName != NULL )
+	{
+		TSG_LOG_DEBUG( "Setting parent of " << currNode_->getName() << " to " << parentName );
+		SceneNode* parent = graph_->getNode(parentName);
+		if ( parent == NULL )
+		{
+			error("Parent " + std::string(parentName) + " of node " + currNode_->getName() + " does not exist.");
+		}
+		parent->addChild(currNode_);
+	}
+	return EK_NODE;
+}
+
+void XmlStreamReader::readPosition(const Tag& tag)
+{
+	const char* value = tag.attribute("value");
+	if ( value == NULL ) return;
+
+	Vector3 pos = ExpressionFactory::getAsSequence<Vector3>(value, 3);
+	translate(currNode_, pos, tinysg::TS_PARENT);
+}
+
+void XmlStreamReader::readOrientation(const Tag& tag)
+{
+	const char* angleStr = tag.attribute("angle");
+	const char* axisStr = tag.attribute("axis");
+	if ( angleStr == NULL || axisStr == NULL ) return;
+
+	Real angle = ExpressionFactory::getAsReal(angleStr);
+	Vector3 axis = ExpressionFactory::getAsSequence<Vector3>(axisStr, 3);
+	rotate(currNode_, Quaternion(angle,axis), tinysg::TS_PARENT);
+}
+
+XmlStreamReader::ElementKind XmlStreamReader::startObject(const Tag& tag)
+{
+	const char* objectName = tag.attribute("name");
+	const char* objectType = tag.attribute("type");
+
+	// Without a type there is nothing to create; skip the whole element
+	if ( objectType == NULL )
+	{
+		TSG_LOG_ERROR( filename << " (" << line_ << "): Object type not specified.");
+		return EK_SKIPPED_OBJECT;
+	}
+
+	info_ = ObjectInfo();
+	info_.type = objectType;
+	if ( (objectName == NULL) || (Archive::UnnamedValue == objectName) )
+	{
+		info_.name = std::string(objectType) + "_" + SceneGraph::generateName();
+	} else {
+		info_.name = objectName;
+	}
+
+	inObject_ = true;
+	return EK_OBJECT;
+}
+
+XmlStreamReader::ElementKind XmlStreamReader::startProperty(const Tag& tag)
+{
+	// IArchive does not look inside properties of unknown class
+	if ( !inObject_ || ( !kinds_.empty() && kinds_.back() == EK_UNKNOWN_PROPERTY ) )
+	{
+		return EK_IGNORED;
+	}
+
+	const char* name = tag.attribute("name");
+	const char* propertyClass = tag.attribute("class");
+	const char* value = tag.attribute("value");
+
+	Property prop( std::string(name != NULL ? name : "") );
+	std::string paramClass( propertyClass != NULL ? propertyClass : "" );
+	std::string paramValue( value != NULL ? value : "" );
+
+	ElementKind kind = EK_PROPERTY;
+	if ( (paramClass == Archive::UnknownValue) || (paramClass == Archive::EmptyValue) )
+	{
+		prop.set_value(Archive::UnknownValue);
+		kind = EK_UNKNOWN_PROPERTY;
+	}
+	else if ( paramClass == "scene_object_ptr" )
+	{
+		prop.set_value( boost::any( graph_->getObject(paramValue) ) );
+	}
+	else
+	{
+		prop.set_value( destringify(paramClass, paramValue) );
+	}
+
+	properties_.push_back(prop);
+	return kind;
+}
+
+/*
+ * Tokenizer. Only tags are returned; everything between them is skipped.
+ */
+bool XmlStreamReader::nextTag(Tag& tag)
+{
+	int c;
+	while ( (c = get()) != EOF )
+	{
+		if ( c != '<' ) continue;
+
+		c = peek();
+		if ( c == '?' )
+		{
+			skipPast("?>");
+			continue;
+		}
+		if ( c == '!' )
+		{
+			get();
+			if ( peek() == '-' )
+			{
+				get(); get();
+				skipPast("-->");
+			}
+			else if ( peek() == '[' )
+			{
+				skipPast("]]>");
+			}
+			else
+			{
+				// DOCTYPE and friends; an internal subset sits in brackets
+				int depth = 0;
+				while ( (c = get()) != EOF && !(c == '>' && depth == 0) )
+				{
+					if ( c == '[' ) ++depth;
+					if ( c == ']' ) --depth;
+				}
+			}
+			continue;
+		}
+
+		tag.attributes.clear();
+		tag.closing = false;
+		tag.selfClosing = false;
+
+		if ( c == '/' )
+		{
+			get();
+			tag.closing = true;
+			readName(tag.name);
+			skipWhiteSpace();
+			if ( get() != '>' ) error("Malformed closing tag </" + tag.name + ">.");
+			return true;
+		}
+
+		readName(tag.name);
+		for (;;)
+		{
+			skipWhiteSpace();
+			c = get();
+			if ( c == '>' ) return true;
+			if ( c == '/' )
+			{
+				if ( get() != '>' ) error("Malformed tag <" + tag.name + ">.");
+				tag.selfClosing = true;
+				return true;
+			}
+			if ( c == EOF ) error("File ends inside tag <" + tag.name + ">.");
+
+			// Attribute
+			--pos_;
+			tag.attributes.push_back( Attribute() );
+			readName(tag.attributes.back().first);
+			skipWhiteSpace();
+			if ( get() != '=' ) error("Attribute " + tag.attributes.back().first + " has no value.");
+			skipWhiteSpace();
+			readAttributeValue(tag.attributes.back().second);
+		}
+	}
+	return false;
+}
+
+int XmlStreamReader::get()
+{
+	int c = peek();
+	if ( c != EOF )
+	{
+		++pos_;
+		if ( c == '\n' ) ++line_;
+	}
+	return c;
+}
+
+int XmlStreamReader::peek()
+{
+	if ( pos_ == end_ )
+	{
+		// Refill. Only ever called with the buffer used up, so nothing that
+		// is still needed gets overwritten.
+		file_.read(&buffer_[0], buffer_.size());
+		end_ = (size_t)file_.gcount();
+		pos_ = 0;
+		if ( end_ == 0 ) return EOF;
+	}
+	return (unsigned char)buffer_[pos_];
+}
+
+void XmlStreamReader::skipWhiteSpace()
+{
+	int c;
+	while ( (c = peek()) == ' ' || c == '\t' || c == '\n' || c == '\r' ) get();
+}
+
+void XmlStreamReader::skipPast(const char* terminator)
+{
+	size_t length = std::strlen(terminator);
+	size_t matched = 0;
+	int c;
+	while ( matched < length && (c = get()) != EOF )
+	{
+		if ( c == terminator[matched] )
+		{
+			++matched;
+		}
+		else if ( !(matched > 0 && c == terminator[0] && terminator[matched - 1] == c) )
+		{
+			// A run of the first character ("--->") keeps the partial match
+			matched = ( c == terminator[0] ) ? 1 : 0;
+		}
+	}
+}
+
+void XmlStreamReader::readName(std::string& name)
+{
+	name.clear();
+	int c;
+	while ( (c = peek()) != EOF && c != ' ' && c != '\t' && c != '\n' && c != '\r'
+			&& c != '/' && c != '>' && c != '=' )
+	{
+		name += (char)get();
+	}
+	if ( name.empty() ) error("Expected a name.");
+}
+
+void XmlStreamReader::readAttributeValue(std::string& value)
+{
+	value.clear();
+	int quote = get();
+	if ( quote != '"' && quote != '\'' ) error("Attribute value is not quoted.");
+
+	int c;
+	while ( (c = get()) != quote )
+	{
+		if ( c == EOF ) error("File ends inside an attribute value.");
+		if ( c == '&' )
+		{
+			appendEntity(value);
+		} else {
+			value += (char)c;
+		}
+	}
+}
+
+void XmlStreamReader::appendEntity(std::string& value)
+{
+	// Called just after the '&'
+	std::string entity;
+	int c;
+	while ( (c = get()) != ';' )
+	{
+		if ( c == EOF || entity.size() > 8 ) error("Malformed entity.");
+		entity += (char)c;
+	}
+
+	if ( entity == "amp" ) value += '&';
+	else if ( entity == "lt" ) value += '<';
+	else if ( entity == "gt" ) value += '>';
+	else if ( entity == "quot" ) value += '"';
+	else if ( entity == "apos" ) value += '\'';
+	else if ( entity.size() > 1 && entity[0] == '#' )
+	{
+		// Character reference, written out as UTF-8
+		unsigned long code = ( entity[1] == 'x' ) ? std::strtoul(entity.c_str() + 2, NULL, 16)
+												 : std::strtoul(entity.c_str() + 1, NULL, 10);
+		if ( code < 0x80 ) {
+			value += (char)code;
+		} else if ( code < 0x800 ) {
+			value += (char)(0xC0 | (code >> 6));
+			value += (char)(0x80 | (code & 0x3F));
+		} else if ( code < 0x10000 ) {
+			value += (char)(0xE0 | (code >> 12));
+			value += (char)(0x80 | ((code >> 6) & 0x3F));
+			value += (char)(0x80 | (code & 0x3F));
+		} else if ( code < 0x110000 ) {
+			value += (char)(0xF0 | (code >> 18));
+			value += (char)(0x80 | ((code >> 12) & 0x3F));
+			value += (char)(0x80 | ((code >> 6) & 0x3F));
+			value += (char)(0x80 | (code & 0x3F));
+		} else {
+			// Past the end of Unicode, left as it was
+			value += '&' + entity + ';';
+		}
+	}
+	else
+	{
+		// Unknown entities are passed through untouched
+		value += '&' + entity + ';';
+	}
+}
+
+void XmlStreamReader::error(const std::string& what) const
+{
+	std::stringstream ss;
+	ss << filename << " (" << line_ << "): " << what;
+	throw ss.str();
+}
+
+}
@@ -0,0 +1,136 @@
+/*************************************************************************
+ * TinySG, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * XmlStreamReader.h
+ *
+ *  Created on: Apr 6, 2009
+ *      Author: yamokosk
+ */
+
+
+#ifndef _TINYSG_XML_STREAM_READER_H_FILE_
+#define _TINYSG_XML_STREAM_READER_H_FILE_
+
+#include "config.h"
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include <api/ObjectModel.h>
+
+namespace tinysg
+{
+
+class SceneGraph;
+class SceneNode;
+
+/*
+ * Loads an XML scene in one pass without building a TiXmlDocument. Tags are
+ * read from a fixed size buffer and turned into createNode()/createObject()
+ * calls as soon as they are complete, so memory use is bounded by the
+ * buffer, the nesting depth and the properties of a single object rather
+ * than by the size of the file.
+ *
+ * Accepts the same files as IArchive and builds the same graph. Text content,
+ * comments, processing instructions, CDATA and DOCTYPE declarations are
+ * skipped. Throws a std::string on malformed input.
+ */
+class XmlStreamReader
+{
+#if defined( TSG_HAVE_LOG4CXX )
+	static log4cxx::LoggerPtr logger;
+#endif
+
+public:
+	static const size_t BufferSize;
+
+	explicit XmlStreamReader(const std::string& f);
+
+	void load(SceneGraph& graph, int& ver);
+
+private:
+	typedef std::pair<std::string, std::string> Attribute;
+
+	// What an open element turned into
+	enum ElementKind
+	{
+		EK_IGNORED,
+		EK_ROOT,
+		EK_NODE,
+		EK_OBJECT,
+		EK_SKIPPED_OBJECT,
+		EK_PROPERTY,
+		EK_UNKNOWN_PROPERTY
+	};
+
+	struct Tag
+	{
+		std::string name;
+		std::vector<Attribute> attributes;
+		bool closing;
+		bool selfClosing;
+
+		// NULL if the tag has no such attribute
+		const char* attribute(const char* name) const;
+	};
+
+	// Element handlers
+	void startElement(const Tag& tag);
+	void endElement();
+	ElementKind startNode(const Tag& tag);
+	ElementKind startObject(const Tag& tag);
+	ElementKind startProperty(const Tag& tag);
+	void readPosition(const Tag& tag);
+	void readOrientation(const Tag& tag);
+
+	// Tokenizer
+	bool nextTag(Tag& tag);
+	int get();
+	int peek();
+	void skipWhiteSpace();
+	void skipPast(const char* terminator);
+	void readName(std::string& name);
+	void readAttributeValue(std::string& value);
+	void appendEntity(std::string& value);
+	void error(const std::string& what) const;
+
+	std::string filename;
+	std::ifstream file_;
+	std::vector<char> buffer_;
+	size_t pos_;
+	size_t end_;
+	int line_;
+
+	// Parser state
+	SceneGraph* graph_;
+	int* version_;
+	// Open elements, outermost first
+	std::vector<std::string> open_;
+	std::vector<ElementKind> kinds_;
+	bool sawWorld_;
+	SceneNode* currNode_;
+	bool inObject_;
+	ObjectInfo info_;
+	// Properties being read, outermost first
+	std::vector<Property> properties_;
+};
+
+}
+
+#endif
@@ -78,12 +78,39 @@ struct ObjectInfo
 	std::vector<TriSurfaceMesh> meshes;
 };
 
+/*
+ * Scene wide state a plugin keeps in its SceneContext
+ */
+struct PluginData
+{
+	virtual ~PluginData() {};
+	//! Called once every node of the scene has its new world pose, on the
+	//! thread that updated the scene. Lets a plugin pass the poses its
+	//! objects collected in notifyMoved() on to its library in one go.
+	virtual void notifyUpdated() {};
+};
+
+/*
+ * Per scene storage for plugins. Objects and queries are handed the context
+ * of the scene that created them before init(), so that a plugin can keep
+ * its world per scene instead of in a process wide singleton.
+ */
+struct SceneContext
+{
+	virtual ~SceneContext() {};
+	//! Returns the data stored under key, or NULL if there is none.
+	virtual PluginData* getPluginData(const std::string& key) const = 0;
+	//! Stores data under key. The context deletes it once the scene is gone.
+	virtual void setPluginData(const std::string& key, PluginData* data) = 0;
+};
+
 /*
  * Scene object interface
  */
 struct SceneObject
 {
 	virtual ~SceneObject() {};
+	virtual void setContext( SceneContext* context ) {};
 	virtual void init( const ObjectInfo& info ) = 0;
 	virtual Property getProperty(const std::string& p) const = 0;
 	virtual void setProperty(const Property& p) = 0;
@@ -121,14 +148,31 @@ struct QueryArguments
 	void resetResults()
 	{
 		objectsInCollision.clear();
+		contactOffsets.clear();
+		contactPositions.clear();
+		contactNormals.clear();
+		contactDepths.clear();
 		distanceMap.clear();
+		critpnt.clear();
+		regpnt.clear();
 	}
 
 	PropertyContainer parameters;
 	std::vector<SceneObjectPair> objectsInCollision;
+	//! Contacts of the pairs in objectsInCollision. Those of pair n are
+	//! numbers contactOffsets[n] up to contactOffsets[n+1], so there is one
+	//! offset more than there are pairs. Positions and normals hold x, y and
+	//! z of each contact in turn, depths one value per contact.
+	std::vector<unsigned int> contactOffsets;
+	std::vector<float> contactPositions;
+	std::vector<float> contactNormals;
+	std::vector<float> contactDepths;
 	std::vector<float> distanceMap;
 	std::vector<Point3D> critpnt;
 	std::vector<Point3D> regpnt;
+	//! Filled by queries that report how the last run went. Survives
+	//! resetResults(), queries overwrite their own entries in place.
+	PropertyContainer statistics;
 };
 
 /*
@@ -137,6 +181,7 @@ struct QueryArguments
 struct Query
 {
 	virtual ~Query() {};
+	virtual void setContext( SceneContext* context ) {};
 	virtual void init() {};
 	virtual void getInfo(QueryInfo* info) = 0;
 	virtual void execute(QueryArguments* args) = 0;
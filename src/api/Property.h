@@ -134,6 +134,11 @@ struct Property
 		return (properties.size() > 0);
 	}
 
+	const PropertyContainer& get_parameters() const
+	{
+		return properties;
+	}
+
 	void set_name(const std::string& name)
 	{
 		name_ = name;
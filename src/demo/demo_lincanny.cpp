@@ -7,7 +7,8 @@ void description()
 		<< "\tCreates a simple 4 node (n1,n2,n3, and n4) scene. Two objects\n"
 		<< "are created and attached to nodes n2 and n3 respectively. Distance\n"
 		<< "queries are then performed on the two objects for different poses of\n"
-		<< "of the parent node of n3.\n\n";
+		<< "of the parent node of n3, and once more for a whole trajectory of the\n"
+		<< "sphere.\n\n";
 }
 
 void printme (const PropertyContainer& props)
@@ -65,6 +66,31 @@ bool rundemo(int argc, char **argv)
 	args = graph.executeQuery("LCDistanceQuery");
 	//LOG4CXX_INFO(demo_logger, "Distance: " << args.distanceMap[0]);
 
+	/* Sweep the sphere along a line in a single query. Every step starts
+	 * from the closest features found in the step before. */
+	const int numSteps = 10;
+	std::vector<double> poses(16 * numSteps, 0.0);
+	for (int s = 0; s < numSteps; ++s)
+	{
+		double* T = &poses[16 * s];
+		T[0] = T[5] = T[10] = T[15] = 1.0;
+		T[12] = 0.5 * s;
+	}
+	Property trajectory("trajectory");
+	trajectory.add_parameter( Property("asphere", poses) );
+
+	QueryArguments sweep;
+	sweep.parameters.push_back( trajectory );
+	graph.executeQuery("LCDistanceQuery", sweep);
+	std::cout << "Trajectory: " << sweep.distanceMap.size() << " distances" << std::endl;
+	BOOST_FOREACH(const Property& stat, sweep.statistics)
+	{
+		if ( contains<int>(stat.const_value()) )
+			std::cout << "  " << stat.name() << ": " << stat.getAndCastValue<int>() << std::endl;
+		else if ( contains<double>(stat.const_value()) )
+			std::cout << "  " << stat.name() << ": " << stat.getAndCastValue<double>() << std::endl;
+	}
+
 	// Test any_cast problem
 	SceneObject* obj = graph.getObject("acube");
 	ObjectInfo cube_info;
@@ -0,0 +1,168 @@
+// Ahead of demowrapper.h, which pulls in tinysg's own RigidBody
+#include <plugins/lincanny/algorithm/BodyManager.h>
+
+#include "demowrapper.h"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+
+const int NumBodies = 20;
+const int NumFrames = 200;
+
+void description()
+{
+	std::cout
+		<< " --== Multi-threaded Lin-Canny distances with TinySG ==--\n\n"
+		<< "\tMoves 20 critical bodies past 20 regular bodies and computes all\n"
+		<< "\t400 pairwise distances per frame with 1, 2 and 4 threads. The\n"
+		<< "\tthreaded runs must reproduce the single threaded distances. A last\n"
+		<< "\trun lets pairs more than 2 units apart skip the closest feature\n"
+		<< "\tsearch and report a lower bound instead. Also counts the mesh points\n"
+		<< "\tthe searches read against the ones they had to transform.\n\n";
+}
+
+// Closed, triangulated unit sphere so every body is a valid convex polyhedron.
+// On a unit sphere the vertex normals are the vertices themselves.
+void writeVertex(std::ofstream& out, double x, double y, double z)
+{
+	out << "v " << x << " " << y << " " << z << "\n";
+	out << "vn " << x << " " << y << " " << z << "\n";
+}
+
+void writeFace(std::ofstream& out, int a, int b, int c)
+{
+	out << "f " << a << "//" << a << " " << b << "//" << b << " " << c << "//" << c << "\n";
+}
+
+void writeSphere(const char* filename, int slices, int stacks)
+{
+	std::ofstream out(filename);
+
+	writeVertex(out, 0.0, 0.0, 1.0);
+	for (int s = 1; s < stacks; ++s)
+	{
+		double phi = M_PI * s / stacks;
+		for (int k = 0; k < slices; ++k)
+		{
+			double theta = 2.0 * M_PI * k / slices;
+			writeVertex(out, std::sin(phi) * std::cos(theta), std::sin(phi) * std::sin(theta), std::cos(phi));
+		}
+	}
+	writeVertex(out, 0.0, 0.0, -1.0);
+
+	// OBJ indices start at one; ring r (0 based) starts at 2 + r * slices
+	int bottom = 2 + (stacks - 1) * slices;
+	for (int k = 0; k < slices; ++k)
+	{
+		int k1 = (k + 1) % slices;
+		writeFace(out, 1, 2 + k, 2 + k1);
+		for (int r = 0; r + 1 < stacks - 1; ++r)
+		{
+			int a = 2 + r * slices, b = a + slices;
+			writeFace(out, a + k, b + k, b + k1);
+			writeFace(out, a + k, b + k1, a + k1);
+		}
+		writeFace(out, bottom, bottom - slices + k1, bottom - slices + k);
+	}
+}
+
+BoundingMesh* loadMesh(const char* filename)
+{
+	BoundingMesh* mesh = new BoundingMesh(filename);
+	mesh->load();
+	return mesh;
+}
+
+void placeBodies(BodyManager& bm, int frame)
+{
+	double t = 0.05 * frame;
+	for (int n = 0; n < bm.getCriticalBodyCount(); ++n)
+	{
+		bm.setCriticalTransform(n, 3.0 * (n % 5) + std::sin(t + n), 3.0 * (n / 5), 0.0, t, 0.5 * t, 0.0);
+	}
+	for (int n = 0; n < bm.getBodyCount(); ++n)
+	{
+		bm.setTransform(n, 3.0 * (n % 5), 3.0 * (n / 5) + std::cos(t - n), 2.0 + std::sin(t), 0.0, t, 0.3 * n);
+	}
+}
+
+// Runs every frame and returns the total time spent in computeDistances()
+double run(BodyManager& bm, int threads, std::vector<double>& distances)
+{
+	using namespace boost::posix_time;
+
+	bm.setNumThreads(threads);
+	placeBodies(bm, 0);
+	bm.init();
+
+	int pairs = bm.getCriticalBodyCount() * bm.getBodyCount();
+	distances.resize(NumFrames * pairs);
+
+	double elapsed = 0.0;
+	for (int frame = 0; frame < NumFrames; ++frame)
+	{
+		placeBodies(bm, frame);
+
+		ptime start = microsec_clock::universal_time();
+		bm.computeDistances();
+		elapsed += (double)(microsec_clock::universal_time() - start).total_microseconds();
+
+		const double* d = bm.getDistances();
+		std::copy(d, d + pairs, distances.begin() + frame * pairs);
+	}
+	return elapsed / 1000.0;
+}
+
+bool rundemo(int argc, char **argv)
+{
+	description();
+
+	const char* filename = "demo_lincanny_sphere.obj";
+	writeSphere(filename, 24, 12);
+
+	BodyManager bm;
+	for (int n = 0; n < NumBodies; ++n) bm.addCriticalBody( loadMesh(filename) );
+	for (int n = 0; n < NumBodies; ++n) bm.addBody( loadMesh(filename) );
+	std::remove(filename);
+
+	std::vector<double> reference, distances;
+	unsigned long lookups = bm.getPointLookupCount(), transforms = bm.getPointTransformCount();
+	double serial = run(bm, 1, reference);
+	lookups = bm.getPointLookupCount() - lookups;
+	transforms = bm.getPointTransformCount() - transforms;
+	std::cout << "1 thread: " << serial << " ms for " << NumFrames << " frames" << std::endl;
+	std::cout << "points: " << lookups << " read, " << transforms << " transformed ("
+		<< (double)lookups / std::max(transforms, 1UL) << "x fewer than without caching)" << std::endl;
+
+	for (int threads = 2; threads <= 4; threads *= 2)
+	{
+		double t = run(bm, threads, distances);
+		std::cout << threads << " threads: " << t << " ms (" << serial / t << "x"
+			<< (distances == reference ? "" : ", RESULTS DIFFER") << ")" << std::endl;
+	}
+
+	const double threshold = 2.0;
+	bm.setDistanceThreshold(threshold);
+	double culled = run(bm, 1, distances);
+	bm.setDistanceThreshold(DOUBLE_MAX);
+
+	// Anything above the threshold may be a bound, the rest should match
+	int bounds = 0;
+	double maxError = 0.0;
+	for (unsigned int k = 0; k < distances.size(); ++k)
+	{
+		if ( distances[k] > threshold ) ++bounds;
+		else maxError = std::max(maxError, std::fabs(distances[k] - reference[k]));
+	}
+	std::cout << "threshold " << threshold << ": " << culled << " ms (" << serial / culled << "x), "
+		<< bounds << " of " << distances.size() << " distances above the threshold, max error below it "
+		<< maxError << std::endl;
+
+	return true;
+}
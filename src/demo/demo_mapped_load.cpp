@@ -0,0 +1,120 @@
+#include "demowrapper.h"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <fstream>
+
+#if TINYSG_PLATFORM != TINYSG_PLATFORM_WIN32
+#	include <sys/resource.h>
+#endif
+
+void usage()
+{
+	std::cout
+		<< "Usage:\n\tdemo_mapped_load scene\n\n"
+		<< "Peak memory is per process, so load the .bin and the .xml version\n"
+		<< "of a scene (see demo_scene_convert) in separate runs.\n";
+}
+
+void description()
+{
+	std::cout
+		<< " --== Scene loading memory demo with TinySG ==--\n\n"
+		<< "\tLoads a scene, picking the format from the file, and reports the\n"
+		<< "\tload time and the memory used next to the size of the file. Binary\n"
+		<< "\tscenes are read through a mapping of the file, but everything in\n"
+		<< "\tthem is copied into the graph and the mapping is gone once the\n"
+		<< "\tscene is loaded.\n\n";
+}
+
+struct MemoryUsage
+{
+	MemoryUsage() : resident(-1), fileBacked(-1), anonymous(-1), peak(-1) {};
+
+	// kB, -1 where the platform does not tell
+	long resident;
+	long fileBacked;
+	long anonymous;
+	long peak;
+};
+
+MemoryUsage memoryUsage()
+{
+	MemoryUsage usage;
+
+#if TINYSG_PLATFORM == TINYSG_PLATFORM_LINUX
+	// File pages mapped while loading show up under RssFile, the graph under RssAnon
+	std::ifstream status("/proc/self/status");
+	std::string key;
+	while ( status >> key )
+	{
+		if ( key == "VmRSS:" ) status >> usage.resident;
+		else if ( key == "RssFile:" ) status >> usage.fileBacked;
+		else if ( key == "RssAnon:" ) status >> usage.anonymous;
+		status.ignore(256, '\n');
+	}
+#endif
+
+#if TINYSG_PLATFORM != TINYSG_PLATFORM_WIN32
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+#	if TINYSG_PLATFORM == TINYSG_PLATFORM_APPLE
+	usage.peak = ru.ru_maxrss / 1024;
+#	else
+	usage.peak = ru.ru_maxrss;
+#	endif
+#endif
+
+	return usage;
+}
+
+void printUsage(const std::string& when, const MemoryUsage& usage)
+{
+	std::cout << when << ": resident " << usage.resident << " kB (file backed "
+		<< usage.fileBacked << " kB, anonymous " << usage.anonymous << " kB), peak "
+		<< usage.peak << " kB" << std::endl;
+}
+
+bool rundemo(int argc, char **argv)
+{
+	using namespace boost::posix_time;
+
+	if ( argc < 2 )
+	{
+		usage();
+		return false;
+	}
+
+	description();
+
+	TinySG::Initialize();
+
+	std::ifstream file(argv[1], std::ios::in | std::ios::binary | std::ios::ate);
+	if ( !file )
+	{
+		std::cout << "Could not open " << argv[1] << std::endl;
+		return false;
+	}
+	long fileSize = (long)(file.tellg() / 1024);
+	file.close();
+
+	std::cout << argv[1] << ": " << (SceneLoader::getFormat(argv[1]) == SF_BINARY ? "binary" : "XML")
+		<< ", " << fileSize << " kB" << std::endl;
+
+	SceneGraph graph;
+	MemoryUsage before = memoryUsage();
+	printUsage("Before loading", before);
+
+	ptime start = microsec_clock::universal_time();
+	SceneLoader::load(argv[1], graph);
+	time_duration elapsed = microsec_clock::universal_time() - start;
+
+	MemoryUsage after = memoryUsage();
+	printUsage("After loading", after);
+
+	std::cout << "Loaded in " << elapsed.total_milliseconds() << " ms, resident memory grew by "
+		<< after.resident - before.resident << " kB, peak by " << after.peak - before.peak
+		<< " kB" << std::endl;
+
+	return true;
+}
@@ -0,0 +1,121 @@
+#include "demowrapper.h"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+#ifndef TSG_HAVE_ODE
+#error demo_ode_spaces requires the ODE library to be installed.
+#endif
+
+void description()
+{
+	std::cout
+		<< " --== ODE space types compared ==--\n\n"
+		<< "\tScatters 1000 randomly sized boxes over a 40 x 40 x 40 region and\n"
+		<< "puts them into one space of each ODE type in turn. Every frame all\n"
+		<< "boxes move a little and the space is collided with itself; the time\n"
+		<< "each collision query takes is averaged over the frames. All spaces\n"
+		<< "should find the same number of colliding pairs.\n\n";
+}
+
+const unsigned int NumBoxes = 1000;
+const unsigned int NumFrames = 50;
+
+// Numbers from a fixed seed, so every space type gets the same scene
+Real uniform(Real lo, Real hi)
+{
+	return lo + (hi - lo) * (Real)std::rand() / (Real)RAND_MAX;
+}
+
+struct SpaceSetup
+{
+	std::string type;
+	PropertyContainer properties;
+};
+
+void runSpace(const SpaceSetup& setup)
+{
+	using namespace boost::posix_time;
+
+	SceneGraph graph;
+	SceneObject* space = graph.createObject("space", setup.type, setup.properties);
+	if ( space == NULL )
+	{
+		std::cout << "  " << setup.type << ": could not be created." << std::endl;
+		return;
+	}
+
+	std::srand(1);
+	std::vector<SceneNode*> nodes;
+	for (unsigned int n = 0; n < NumBoxes; ++n)
+	{
+		std::stringstream ss;
+		ss << "box" << n;
+
+		SceneNode* node = graph.getNode(SceneGraph::World)->createChild(ss.str());
+		translate(node, Vector3(uniform(-20.0, 20.0), uniform(-20.0, 20.0), uniform(-20.0, 20.0)));
+
+		PropertyContainer box_properties;
+		box_properties.push_back( Property("lengths", Vector3(uniform(0.2, 2.0), uniform(0.2, 2.0), uniform(0.2, 2.0))) );
+		box_properties.push_back( Property("space", space) );
+		node->attach( graph.createObject(ss.str(), "ODEBox", box_properties) );
+		nodes.push_back(node);
+	}
+
+	QueryArguments args;
+	args.parameters.push_back( Property("CollisionPair", SceneObjectPair(space, space)) );
+
+	double elapsed = 0.0;
+	unsigned long collisions = 0;
+	for (unsigned int frame = 0; frame < NumFrames; ++frame)
+	{
+		BOOST_FOREACH(SceneNode* node, nodes)
+		{
+			translate(node, Vector3(uniform(-0.1, 0.1), uniform(-0.1, 0.1), uniform(-0.1, 0.1)));
+		}
+		graph.update();
+
+		args.resetResults();
+		ptime start = microsec_clock::universal_time();
+		graph.executeQuery("ODECollisionQuery", args);
+		elapsed += (double)(microsec_clock::universal_time() - start).total_microseconds();
+		collisions += args.objectsInCollision.size();
+	}
+
+	std::cout << "  " << setup.type << ": " << elapsed / NumFrames / 1000.0 << " ms per query, "
+		<< collisions << " colliding pairs over " << NumFrames << " frames." << std::endl;
+}
+
+bool rundemo(int argc, char **argv)
+{
+	description();
+
+	TinySG::Initialize();
+
+	std::vector<SpaceSetup> setups(4);
+
+	setups[0].type = "ODESimpleSpace";
+
+	// Cells from 1 to 4 units, about the size of the boxes
+	setups[1].type = "ODEHashSpace";
+	setups[1].properties.push_back( Property("min_level", int(0)) );
+	setups[1].properties.push_back( Property("max_level", int(2)) );
+
+	setups[2].type = "ODEQuadTreeSpace";
+	setups[2].properties.push_back( Property("center", Vector3(0.0, 0.0, 0.0)) );
+	setups[2].properties.push_back( Property("extents", Vector3(21.0, 21.0, 21.0)) );
+	setups[2].properties.push_back( Property("depth", int(5)) );
+
+	setups[3].type = "ODESweepAndPruneSpace";
+	setups[3].properties.push_back( Property("axis_order", std::string("xyz")) );
+
+	std::cout << NumBoxes << " boxes, self collision of one space:" << std::endl;
+	BOOST_FOREACH(const SpaceSetup& setup, setups)
+	{
+		runSpace(setup);
+	}
+
+	return true;
+}
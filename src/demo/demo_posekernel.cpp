@@ -0,0 +1,117 @@
+#include "demowrapper.h"
+
+#include <PoseKernel.h>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+
+void description()
+{
+	std::cout
+		<< " --== Pose composition kernel benchmark with TinySG ==--\n\n"
+		<< "\tComposes 1k to 1M parent/child poses with the scalar Quaternion\n"
+		<< "\tand Vector3 operators and with each batch kernel the CPU supports.\n\n";
+}
+
+float randomReal()
+{
+	return (float)std::rand() / (float)RAND_MAX - 0.5f;
+}
+
+/*
+ * Slots [0, n) hold parent world poses, slots [n, 2n) the children to be
+ * composed. Every child picks a random parent so the kernels have to gather,
+ * just like a level of the transform store.
+ */
+struct PoseSet
+{
+	std::vector<int> parent;
+	std::vector<Vector3> localPos, worldPos;
+	std::vector<Quaternion> localRot, worldRot;
+
+	PoseSet(unsigned int n) :
+		parent(2 * n, -1),
+		localPos(2 * n), worldPos(2 * n),
+		localRot(2 * n), worldRot(2 * n)
+	{
+		for (unsigned int i = 0; i < 2 * n; ++i)
+		{
+			Quaternion q(randomReal(), randomReal(), randomReal(), randomReal());
+			q.normalise();
+			Vector3 p(randomReal(), randomReal(), randomReal());
+
+			localPos[i] = worldPos[i] = p;
+			localRot[i] = worldRot[i] = q;
+			if ( i >= n ) parent[i] = std::rand() % n;
+		}
+	}
+};
+
+void composeWithLinalg(PoseSet& s, unsigned int first, unsigned int last)
+{
+	for (unsigned int i = first; i < last; ++i)
+	{
+		Quaternion q_parent = s.worldRot[ s.parent[i] ];
+		Vector3 p_parent = s.worldPos[ s.parent[i] ];
+
+		s.worldRot[i] = q_parent * s.localRot[i];
+		s.worldPos[i] = q_parent * s.localPos[i] + p_parent;
+	}
+}
+
+void composeWithKernel(PoseSet& s, unsigned int first, unsigned int last, PoseKernelType type)
+{
+	compose_poses(type, first, last, &s.parent[0],
+				  s.localPos[0].ptr(), s.localRot[0].ptr(),
+				  s.worldPos[0].ptr(), s.worldRot[0].ptr());
+}
+
+bool rundemo(int argc, char **argv)
+{
+	using namespace boost::posix_time;
+
+	description();
+
+	PoseKernelType best = best_pose_kernel();
+	std::cout << "Best kernel on this CPU: " << pose_kernel_name(best) << std::endl << std::endl;
+
+	for (unsigned int n = 1000; n <= 1000000; n *= 10)
+	{
+		PoseSet s(n);
+		// Roughly ten million poses per measurement
+		unsigned int reps = std::max(1u, 10000000u / n);
+
+		ptime start = microsec_clock::universal_time();
+		for (unsigned int r = 0; r < reps; ++r) composeWithLinalg(s, n, 2 * n);
+		double linalg = (double)(microsec_clock::universal_time() - start).total_microseconds() / reps;
+
+		std::vector<Vector3> refPos(s.worldPos);
+		std::vector<Quaternion> refRot(s.worldRot);
+
+		std::cout << n << " poses: linalg " << linalg << " us";
+		for (int k = PK_SCALAR; k <= (int)best; ++k)
+		{
+			PoseKernelType type = (PoseKernelType)k;
+			std::fill(s.worldPos.begin() + n, s.worldPos.end(), Vector3::ZERO);
+			std::fill(s.worldRot.begin() + n, s.worldRot.end(), Quaternion::IDENTITY);
+
+			start = microsec_clock::universal_time();
+			for (unsigned int r = 0; r < reps; ++r) composeWithKernel(s, n, 2 * n, type);
+			double t = (double)(microsec_clock::universal_time() - start).total_microseconds() / reps;
+
+			bool identical = ( std::memcmp(&refPos[0], &s.worldPos[0], refPos.size() * sizeof(Vector3)) == 0 &&
+							   std::memcmp(&refRot[0], &s.worldRot[0], refRot.size() * sizeof(Quaternion)) == 0 );
+
+			std::cout << ", " << pose_kernel_name(type) << " " << t << " us ("
+				<< linalg / t << "x" << (identical ? "" : ", RESULTS DIFFER") << ")";
+		}
+		std::cout << std::endl;
+	}
+
+	return true;
+}
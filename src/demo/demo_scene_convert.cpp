@@ -0,0 +1,41 @@
+#include "demowrapper.h"
+
+void usage()
+{
+	std::cout
+		<< "Usage:\n\tdemo_scene_convert input_scene output_scene [xml|binary]\n";
+}
+
+void description()
+{
+	std::cout
+		<< " --== Scene file converter with TinySG ==--\n\n"
+		<< "\tConverts a scene file between the XML and binary formats. The input\n"
+		<< "\tformat is detected automatically; the output defaults to binary.\n\n";
+}
+
+bool rundemo(int argc, char **argv)
+{
+	if ( argc < 3 )
+	{
+		usage();
+		return false;
+	}
+
+	description();
+
+	TinySG::Initialize();
+
+	SceneFormat format = SF_BINARY;
+	if ( argc > 3 && std::string(argv[3]) == "xml" ) format = SF_XML;
+
+	std::cout << "Converting " << argv[1]
+		<< ( SceneLoader::getFormat(argv[1]) == SF_BINARY ? " (binary)" : " (xml)" )
+		<< " to " << argv[2]
+		<< ( format == SF_BINARY ? " (binary)" : " (xml)" ) << std::endl;
+
+	SceneLoader::convert(argv[1], argv[2], format);
+	std::cout << "Done." << std::endl;
+
+	return true;
+}
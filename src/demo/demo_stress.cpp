@@ -1,6 +1,10 @@
 #include "demowrapper.h"
 
 #include <boost/timer.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <algorithm>
+#include <vector>
 
 
 void description()
@@ -53,6 +57,92 @@ void createBigGraph(SceneGraph& graph)
 	createChildren(ptr, num_levels);
 }
 
+void collectNodes(SceneNode* node, std::vector<SceneNode*>& nodes)
+{
+	nodes.push_back(node);
+	SceneNode::ChildIterator iter = node->getChildren();
+	while ( iter.hasMoreElements() )
+	{
+		collectNodes(iter.getNext(), nodes);
+	}
+}
+
+/*
+ * Checks that the threaded update produces bit-for-bit the same world poses
+ * as the old serial update.
+ */
+bool verifyAgainstReference(SceneGraph& graph)
+{
+	SceneNode* n1 = graph.getNode("n1");
+	std::vector<SceneNode*> nodes;
+	collectNodes(n1, nodes);
+
+	rotate(n1, Vector3(0.0, 0.0, 1.0), 0.3);
+	graph.update();
+
+	std::vector<Vector3> positions;
+	std::vector<Quaternion> orientations;
+	for (unsigned int n = 0; n < nodes.size(); ++n)
+	{
+		positions.push_back( nodes[n]->getPosition(TS_WORLD) );
+		orientations.push_back( nodes[n]->getOrientation(TS_WORLD) );
+	}
+
+	// Touch n1 so the whole tree is recomputed from the same inputs
+	translate(n1, Vector3(0.0, 0.0, 0.0));
+	graph.__deprecated_update();
+
+	unsigned int mismatches = 0;
+	for (unsigned int n = 0; n < nodes.size(); ++n)
+	{
+		if ( !(positions[n] == nodes[n]->getPosition(TS_WORLD)) ||
+			 !(orientations[n] == nodes[n]->getOrientation(TS_WORLD)) )
+		{
+			++mismatches;
+		}
+	}
+
+	std::cout << "Threaded update checked against old method: " << mismatches
+		<< " of " << nodes.size() << " nodes differ." << std::endl;
+	return (mismatches == 0);
+}
+
+/*
+ * Moves the top node every frame and records the wall clock time each call to
+ * SceneGraph::update() takes. boost::timer measures process CPU time, which is
+ * meaningless once more than one thread is working, so the microsecond clock
+ * is used instead.
+ */
+void measureFrameLatency(SceneGraph& graph, const std::vector<SceneNode*>& moving, unsigned int num_frames)
+{
+	using namespace boost::posix_time;
+
+	double total = 0.0, fastest = 0.0, slowest = 0.0;
+
+	for (unsigned int frame = 0; frame < num_frames; ++frame)
+	{
+		BOOST_FOREACH(SceneNode* node, moving)
+		{
+			translate(node, Vector3(0.001, 0.0, 0.0));
+		}
+
+		ptime start = microsec_clock::universal_time();
+		graph.update();
+		double dt = (double)(microsec_clock::universal_time() - start).total_microseconds();
+
+		total += dt;
+		fastest = (frame == 0) ? dt : std::min(fastest, dt);
+		slowest = (frame == 0) ? dt : std::max(slowest, dt);
+	}
+
+	std::cout << "  " << graph.getNumThreads() << " thread(s), " << num_frames << " frames: "
+		<< "mean " << total / num_frames << " us, "
+		<< "min " << fastest << " us, "
+		<< "max " << slowest << " us per update, "
+		<< graph.getUpdateStats().visited << " nodes visited, "
+		<< graph.getUpdateStats().recomputed << " recomputed." << std::endl;
+}
+
 bool rundemo(int argc, char **argv)
 {
 	description();
@@ -95,6 +185,60 @@ bool rundemo(int argc, char **argv)
 		stop = stopwatch.elapsed();
 		std::cout << "Graph updated (old method) in " << stop << " seconds." << std::endl;
 	}
+
+	if ( !verifyAgainstReference(graph) ) return false;
+
+	{
+		// Per-frame latency with the graph's persistent worker pool
+		const unsigned int num_frames = 2000;
+
+		// Worst case: the top node moves and drags the whole tree along
+		std::vector<SceneNode*> moving(1, graph.getNode("n1"));
+		std::cout << "Per-frame update latency, moving the top node:" << std::endl;
+		for (unsigned int n = 1; n <= 4; n *= 2)
+		{
+			graph.setNumThreads(n);
+			measureFrameLatency(graph, moving, num_frames);
+		}
+
+		// Typical case: a handful of leaves (joints near the end of a chain)
+		std::vector<SceneNode*> nodes;
+		collectNodes(graph.getNode("n1"), nodes);
+		std::vector<SceneNode*> leaves;
+		BOOST_FOREACH(SceneNode* node, nodes)
+		{
+			if ( !node->getChildren().hasMoreElements() ) leaves.push_back(node);
+		}
+		moving.clear();
+		for (unsigned int n = 0; n < leaves.size(); n += std::max<size_t>(1, leaves.size() / 8))
+		{
+			moving.push_back(leaves[n]);
+		}
+		std::cout << "Per-frame update latency, moving " << moving.size() << " leaves:" << std::endl;
+		for (unsigned int n = 1; n <= 4; n *= 2)
+		{
+			graph.setNumThreads(n);
+			measureFrameLatency(graph, moving, num_frames);
+		}
+	}
+
+	{
+		// Teardown and a second build, both going through the graph's node pool
+		stopwatch.restart();
+		graph.clearScene();
+		stop = stopwatch.elapsed();
+		std::cout << "Cleared big graph in " << stop << " seconds." << std::endl;
+
+		stopwatch.restart();
+		createBigGraph(graph);
+		stop = stopwatch.elapsed();
+		std::cout << "Re-created big graph in " << stop << " seconds." << std::endl;
+
+		stopwatch.restart();
+		graph.clearScene();
+		stop = stopwatch.elapsed();
+		std::cout << "Cleared big graph in " << stop << " seconds." << std::endl;
+	}
 	return true;
 }
 
@@ -0,0 +1,110 @@
+#include "demowrapper.h"
+
+#include <Archive.h>
+#include <XmlStreamReader.h>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <cstdlib>
+
+#if TINYSG_PLATFORM != TINYSG_PLATFORM_WIN32
+#	include <sys/resource.h>
+#endif
+
+void usage()
+{
+	std::cout
+		<< "Usage:\n"
+		<< "\tdemo_xml_stream scene.xml generate num_nodes\n"
+		<< "\tdemo_xml_stream scene.xml dom\n"
+		<< "\tdemo_xml_stream scene.xml stream\n\n"
+		<< "Peak memory is per process, so run dom and stream separately.\n";
+}
+
+void description()
+{
+	std::cout
+		<< " --== Streaming XML loader benchmark with TinySG ==--\n\n"
+		<< "\tLoads an XML scene either through the TinyXML DOM (IArchive) or\n"
+		<< "\tthe streaming reader and reports load time and peak memory.\n\n";
+}
+
+long peakMemoryKB()
+{
+#if TINYSG_PLATFORM != TINYSG_PLATFORM_WIN32
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#	if TINYSG_PLATFORM == TINYSG_PLATFORM_APPLE
+	return usage.ru_maxrss / 1024;
+#	else
+	return usage.ru_maxrss;
+#	endif
+#else
+	return -1;
+#endif
+}
+
+void generate(const char* filename, unsigned int num_nodes)
+{
+	SceneGraph graph(1);
+	std::vector<SceneNode*> nodes(1, graph.getNode(SceneGraph::World));
+	for (unsigned int n = 0; n < num_nodes; ++n)
+	{
+		SceneNode* child = nodes[ std::rand() % nodes.size() ]->createChild();
+		translate(child, Vector3(1.0, 0.5, 0.25));
+		rotate(child, Vector3(0.0, 0.0, 1.0), 0.1);
+		nodes.push_back(child);
+	}
+	SceneLoader::save(filename, graph);
+	std::cout << "Wrote " << num_nodes << " nodes to " << filename << std::endl;
+}
+
+bool rundemo(int argc, char **argv)
+{
+	using namespace boost::posix_time;
+
+	if ( argc < 3 )
+	{
+		usage();
+		return false;
+	}
+
+	description();
+
+	TinySG::Initialize();
+
+	std::string mode(argv[2]);
+	if ( mode == "generate" )
+	{
+		generate(argv[1], (argc > 3) ? std::atoi(argv[3]) : 100000);
+		return true;
+	}
+
+	SceneGraph graph(1);
+	long before = peakMemoryKB();
+	ptime start = microsec_clock::universal_time();
+
+	int version = 0;
+	if ( mode == "dom" )
+	{
+		IArchive ar(argv[1]);
+		ar.init();
+		ar.serialize(graph, version);
+	}
+	else if ( mode == "stream" )
+	{
+		XmlStreamReader reader(argv[1]);
+		reader.load(graph, version);
+	}
+	else
+	{
+		usage();
+		return false;
+	}
+
+	time_duration elapsed = microsec_clock::universal_time() - start;
+	std::cout << mode << ": loaded in " << elapsed.total_milliseconds() << " ms, peak memory "
+		<< peakMemoryKB() << " kB (" << before << " kB before loading)" << std::endl;
+
+	return true;
+}
@@ -30,7 +30,7 @@
 #include <linalg/Matrix3.h>
 #include <boost/foreach.hpp>
 
-#include "algorithm/BodyManager.h"
+#include "LinCannyScene.h"
 
 using namespace tinysg;
 
@@ -51,6 +51,8 @@ int BodyAdapter::destroy(void *p)
 }
 
 BodyAdapter::BodyAdapter() :
+	scene(NULL),
+	manager(NULL),
 	bodyID(-1)
 {
 }
@@ -59,6 +61,12 @@ BodyAdapter::~BodyAdapter()
 {
 }
 
+void BodyAdapter::setContext(tinysg::SceneContext* context)
+{
+	scene = LinCannyScene::get(context);
+	manager = ( scene != NULL ) ? &scene->bodies : NULL;
+}
+
 void BodyAdapter::init(const tinysg::ObjectInfo& info)
 {
 	// Set object name
@@ -75,11 +83,20 @@ void BodyAdapter::init(const tinysg::ObjectInfo& info)
 		setProperty(p);
 	}
 
+	if ( manager == NULL )
+	{
+		LOG_ERROR(services, "Body \"" + name + "\" was not created by a scene and has no distance world to join.");
+		return;
+	}
+
 	if ( bodyType == Critical ) {
-		bodyID = BodyManager::getInstance().addCriticalBody( &meshes[0], meshes.size() );
+		bodyID = manager->addCriticalBody( &meshes[0], meshes.size() );
 	} else {
-		bodyID = BodyManager::getInstance().addBody( &meshes[0], meshes.size() );
+		bodyID = manager->addBody( &meshes[0], meshes.size() );
 	}
+
+	LinCannyScene::BodyRef ref = { bodyType == Critical, bodyID };
+	scene->names[name] = ref;
 }
 
 Property BodyAdapter::getProperty(const std::string& name) const
@@ -106,6 +123,12 @@ void BodyAdapter::setProperty(const Property& p)
 
 		BoundingMesh* bm = new BoundingMesh(filename.c_str());
 
+		Property cache_property = p.get_parameter("cache");
+		if ( !cache_property.value().empty() )
+		{
+			bm->setUseCache( boost::any_cast<int>( cache_property.value() ) != 0 );
+		}
+
 		LOG_MESSAGE(services, "Distance query plugin: Trying to load " + filename);
 
 		if ( !bm->load() )
@@ -148,17 +171,17 @@ void BodyAdapter::setProperty(const Property& p)
 void BodyAdapter::getInfo(tinysg::ObjectInfo& info) const
 {
 	info.name = name;
+	info.type = ( bodyType == Critical ) ? "LCCritBody" : "LCBody";
+	if ( bodyID < 0 ) return;
 
 	RigidBody* pBody = NULL;
 	if ( bodyType == Critical )
 	{
-		info.type = "LCCritBody";
-		pBody = (BodyManager::getInstance().getCriticalBodyArray())[bodyID];
+		pBody = manager->getCriticalBody(bodyID);
 	}
 	else
 	{
-		info.type = "LCBody";
-		pBody = (BodyManager::getInstance().getBodyArray())[bodyID];
+		pBody = manager->getBody(bodyID);
 	}
 
 	for (int n=0; n < (int)meshes.size(); ++n)
@@ -171,6 +194,10 @@ void BodyAdapter::getInfo(tinysg::ObjectInfo& info) const
 		tinysg::Property filename_property("filename", std::string(mesh->filename) );
 		filename_property.add_parameter( Property("color", Vector3(colors[n])) );
 		filename_property.add_parameter( Property("alpha", float(alphas[n])) );
+		if ( mesh->getUseCache() )
+		{
+			filename_property.add_parameter( Property("cache", int(1)) );
+		}
 		info.addProperty( filename_property );
 
 		// Report back mesh data
@@ -237,13 +264,15 @@ void BodyAdapter::notifyMoved( const float* translation, const float* rotation )
 	T[14] = (double)translation[2];
 	T[15] = 1.0;
 
+	if ( manager == NULL ) return;
+
 	if ( bodyType == Critical )
 	{
-		BodyManager::getInstance().setCriticalTransform(bodyID, T);
+		manager->setCriticalTransform(bodyID, T);
 	}
 	else
 	{
-		BodyManager::getInstance().setTransform(bodyID, T);
+		manager->setTransform(bodyID, T);
 	}
 }
 
@@ -17,6 +17,9 @@ namespace plugin = obrsp::plugin;
 
 #include "algorithm/BoundingMesh.h"
 
+class BodyManager;
+struct LinCannyScene;
+
 class BodyAdapter : public tinysg::SceneObject
 {
 	enum BodyType
@@ -33,6 +36,7 @@ public:
 	~BodyAdapter();
 
 	// SceneObject methods
+	virtual void setContext(tinysg::SceneContext* context);
 	virtual void init(const tinysg::ObjectInfo& info);
 	virtual tinysg::Property getProperty(const std::string& name) const;
 	virtual void setProperty(const tinysg::Property& p);
@@ -47,6 +51,9 @@ private:
 	Vector3 getPosition() const;
 	Quaternion getOrientation() const;
 
+	// LinCanny world of the scene this object belongs to
+	LinCannyScene* scene;
+	BodyManager* manager;
 	int bodyID;
 	BodyType bodyType;
 	//RigidBody* bodyptr;
@@ -25,11 +25,15 @@
 #include "DistanceQuery.h"
 #include <api/Services.h>
 #include <boost/any.hpp>
+#include <boost/foreach.hpp>
 
-#include "algorithm/BodyManager.h"
+#include "LinCannyScene.h"
 
 #include <linalg/Vector3.h>
 
+#include <algorithm>
+#include <cstring>
+
 using namespace obrsp::linalg;
 using namespace tinysg;
 
@@ -51,7 +55,40 @@ int DistanceQuery::destroy(void *p)
 	return 0;
 }
 
-DistanceQuery::DistanceQuery()
+static const double* getPose(BodyManager& bm, const LinCannyScene::BodyRef& ref)
+{
+	return ref.critical ? bm.getCriticalBody(ref.id)->transform : bm.getBody(ref.id)->transform;
+}
+
+static void setPose(BodyManager& bm, const LinCannyScene::BodyRef& ref, const double* T)
+{
+	if ( ref.critical )
+		bm.setCriticalTransform(ref.id, T);
+	else
+		bm.setTransform(ref.id, T);
+}
+
+// Overwrites the statistic in place when the arguments already hold it, which
+// unlike adding a Property needs no memory
+template<class T>
+static void setStatistic(PropertyContainer& statistics, const char* name, const T& value)
+{
+	BOOST_FOREACH(Property& stat, statistics)
+	{
+		if ( stat.name_str() != name ) continue;
+
+		T* current = boost::any_cast<T>( &stat.value() );
+		if ( current != NULL )
+			*current = value;
+		else
+			stat.set_value(value);
+		return;
+	}
+	statistics.push_back( Property(name, value) );
+}
+
+DistanceQuery::DistanceQuery() :
+	scene(NULL)
 {
 
 }
@@ -60,57 +97,179 @@ DistanceQuery::~DistanceQuery()
 {
 }
 
+void DistanceQuery::setContext(tinysg::SceneContext* context)
+{
+	scene = LinCannyScene::get(context);
+}
+
 void DistanceQuery::init()
 {
-	BodyManager::getInstance().init();
+	if ( scene != NULL ) scene->bodies.init();
 }
 
 void DistanceQuery::getInfo(tinysg::QueryInfo* i)
 {
 }
 
-void DistanceQuery::execute(tinysg::QueryArguments* args)
+bool DistanceQuery::readTrajectory(const Property& param, std::vector<TrajectoryBody>& bodies, int& numSteps)
 {
-	LOG_MESSAGE(services, "In DistanceQuery::execute()");
+	bodies.clear();
+	numSteps = 0;
+
+	BOOST_FOREACH(const Property& path, param.get_parameters())
+	{
+		LinCannyScene::BodyMap::const_iterator it = scene->names.find( path.name_str() );
+		if ( it == scene->names.end() )
+		{
+			LOG_ERROR(services, "Distance query trajectory names unknown LinCanny object \"" + path.name_str() + "\".");
+			return false;
+		}
+
+		const std::vector<double>* poses = boost::any_cast< std::vector<double> >( &path.const_value() );
+		if ( poses == NULL || poses->empty() || poses->size() % 16 != 0 )
+		{
+			LOG_ERROR(services, "Trajectory for \"" + path.name_str() + "\" is not a std::vector<double> of 4x4 transforms.");
+			return false;
+		}
+
+		int steps = (int)poses->size() / 16;
+		if ( !bodies.empty() && steps != numSteps )
+		{
+			LOG_ERROR(services, "Trajectories of the distance query differ in length.");
+			return false;
+		}
+		numSteps = steps;
 
-	BodyManager& bm = BodyManager::getInstance();
+		TrajectoryBody body = { it->second, poses };
+		bodies.push_back(body);
+	}
 
-	if ( !bm.computeDistances() )
+	if ( bodies.empty() )
+	{
+		LOG_ERROR(services, "Trajectory of the distance query moves no objects.");
+		return false;
+	}
+	return true;
+}
+
+void DistanceQuery::execute(tinysg::QueryArguments* args)
+{
+	if ( scene == NULL )
 	{
-		LOG_ERROR(services, "Distance query failed for unknown reason.");
+		LOG_ERROR(services, "Distance query was not created by a scene and has no bodies to work on.");
 		return;
 	}
+	BodyManager& bm = scene->bodies;
+
+	// Optional parameters:
+	//  - "threads" (int) spreads the body pairs over several threads
+	//  - "distance_threshold" (double) reports pairs whose bounding spheres are
+	//    further apart than this with a lower bound instead of their distance.
+	//    Any distance above the threshold is such a bound.
+	//  - "search_depth" (int) caps the steps a closest feature search takes
+	//    from the closest features of the previous run (default 50)
+	//  - "warm_start" (bool) false searches every pair from scratch instead
+	//  - "trajectory" computes the distances for a sequence of poses rather
+	//    than the current one. Its nested parameters are named after LinCanny
+	//    objects and hold a std::vector<double> of 4x4 column major world
+	//    transforms, 16 values per step and the same number of steps for each
+	//    object. Every step starts from the closest features of the step
+	//    before, results are appended step after step and the objects are put
+	//    back where they were afterwards.
+	double threshold = DOUBLE_MAX;
+	int depth = 50;
+	bool warmStart = true;
+	int numSteps = 1;
+	trajectory.clear();
+	BOOST_FOREACH(const Property& param, args->parameters)
+	{
+		try
+		{
+			if ( param.name_str() == "threads" )
+				bm.setNumThreads( boost::any_cast<int>(param.const_value()) );
+			else if ( param.name_str() == "distance_threshold" )
+				threshold = boost::any_cast<double>(param.const_value());
+			else if ( param.name_str() == "search_depth" )
+				depth = boost::any_cast<int>(param.const_value());
+			else if ( param.name_str() == "warm_start" )
+				warmStart = boost::any_cast<bool>(param.const_value());
+			else if ( param.name_str() == "trajectory" && !readTrajectory(param, trajectory, numSteps) )
+				return;
+		}
+		catch (boost::bad_any_cast &)
+		{
+			LOG_WARNING(services, std::string("Distance query parameter '") + param.name() + "' has the wrong type. Ignoring it.");
+		}
+	}
+	bm.setDistanceThreshold(threshold);
+	bm.setSearchDepth(depth);
 
-	// Get distance data
-	VERTEX3D** critPoints = bm.getCriticalPointArray();
-	VERTEX3D** regPoints = bm.getPointArray();
-	double** distances = bm.getDistancesArray();
-	VERTEX3D pnt;
+	// Poses the trajectory overrides
+	savedPoses.resize(16 * trajectory.size());
+	for (unsigned int n = 0; n < trajectory.size(); ++n)
+	{
+		std::memcpy(&savedPoses[16*n], getPose(bm, trajectory[n].ref), 16*sizeof(double));
+	}
 
-	std::stringstream ss;
-	ss << "Num crit bodies: " << bm.getCriticalBodyCount() << ", Num reg bodies: " << bm.getBodyCount() << std::endl;
+	// Room for every step, so that arguments reused from an earlier query
+	// of the same size need no new memory
+	int numPairs = bm.getCriticalBodyCount() * bm.getBodyCount();
+	args->critpnt.reserve( args->critpnt.size() + numSteps * numPairs );
+	args->regpnt.reserve( args->regpnt.size() + numSteps * numPairs );
+	args->distanceMap.reserve( args->distanceMap.size() + numSteps * numPairs );
 
-	LOG_MESSAGE(services, ss.str());
-	for (int ii = 0; ii < bm.getCriticalBodyCount(); ++ii)
+	unsigned long lookups = bm.getPointLookupCount();
+	unsigned long transforms = bm.getPointTransformCount();
+	int iterations = 0, maxIterations = 0;
+	bool failed = false;
+
+	for (int step = 0; step < numSteps && !failed; ++step)
 	{
-		for (int jj = 0; jj < bm.getBodyCount(); ++jj)
+		for (unsigned int n = 0; n < trajectory.size(); ++n)
 		{
-			pnt = critPoints[ ii ][ jj ];
-			//std::cout << "c: " << critPoints[ ii ][ jj ].x << ", " << critPoints[ ii ][ jj ].y << ", " << critPoints[ ii ][ jj ].z << std::endl;
-			//std::cout << "c: " << pnt.x << ", " << pnt.y << ", " << pnt.z << std::endl;
-			Vector3 p( (Real)pnt.x, (Real)pnt.y, (Real)pnt.z );
+			setPose(bm, trajectory[n].ref, &(*trajectory[n].poses)[16*step]);
+		}
+		if ( !warmStart ) bm.resetWarmStarts();
+
+		if ( !bm.computeDistances() )
+		{
+			LOG_ERROR(services, "Distance query failed for unknown reason.");
+			failed = true;
+			break;
+		}
 
-			pnt = regPoints[ ii ][ jj ];
-			//std::cout << "r: " << regPoints[ ii ][ jj ].x << ", " << regPoints[ ii ][ jj ].y << ", " << regPoints[ ii ][ jj ].z << std::endl;
-			//std::cout << "r: " << pnt.x << ", " << pnt.y << ", " << pnt.z << std::endl;
-			Vector3 q( (Real)pnt.x, (Real)pnt.y, (Real)pnt.z );
+		// Get distance data, one entry per body pair in row major order
+		const VERTEX3D* critPoints = bm.getCriticalPoints();
+		const VERTEX3D* regPoints = bm.getPoints();
+		const double* distances = bm.getDistances();
+		const int* pairIterations = bm.getIterations();
 
-			float dist = (float)distances[ii][jj];
+		for (int k = 0; k < numPairs; ++k)
+		{
+			const VERTEX3D& p = critPoints[k];
+			const VERTEX3D& q = regPoints[k];
+
+			args->critpnt.push_back( Point3D( (Real)p.x, (Real)p.y, (Real)p.z ) );
+			args->regpnt.push_back( Point3D( (Real)q.x, (Real)q.y, (Real)q.z ) );
+			args->distanceMap.push_back( (float)distances[k] );
 
-			args->critpnt.push_back( Point3D(p[0], p[1], p[2]) );
-			args->regpnt.push_back( Point3D(q[0], q[1], q[2]) );
-			args->distanceMap.push_back(dist);
+			iterations += pairIterations[k];
+			maxIterations = std::max(maxIterations, pairIterations[k]);
 		}
 	}
-	LOG_MESSAGE(services, "Leaving DistanceQuery::execute()");
+
+	for (unsigned int n = 0; n < trajectory.size(); ++n)
+	{
+		setPose(bm, trajectory[n].ref, &savedPoses[16*n]);
+	}
+	if ( failed ) return;
+
+	// Points the searches read and how many of them the caches already had
+	lookups = bm.getPointLookupCount() - lookups;
+	transforms = bm.getPointTransformCount() - transforms;
+
+	setStatistic(args->statistics, "steps", numSteps);
+	setStatistic(args->statistics, "iterations", iterations);
+	setStatistic(args->statistics, "max_iterations", maxIterations);
+	setStatistic(args->statistics, "cache_hit_rate", (lookups > 0) ? 1.0 - (double)transforms / lookups : 0.0);
 }
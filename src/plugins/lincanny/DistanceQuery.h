@@ -27,6 +27,8 @@
 
 #include <api/ObjectModel.h>
 
+#include "LinCannyScene.h"
+
 #include <plugin_framework/Plugin.h>
 namespace plugin = obrsp::plugin;
 
@@ -43,6 +45,7 @@ public:
 	~DistanceQuery();
 
 	// Inherited from Query
+	virtual void setContext(tinysg::SceneContext* context);
 	virtual void init();
 	virtual void getInfo(tinysg::QueryInfo* info);
 	virtual void execute(tinysg::QueryArguments* arg);
@@ -50,7 +53,24 @@ public:
 	const plugin::PF_PlatformServices* services;
 
 private:
+	// A LinCanny object moved by the "trajectory" parameter
+	struct TrajectoryBody
+	{
+		LinCannyScene::BodyRef ref;
+		// 4x4 column major world transforms, 16 values per step
+		const std::vector<double>* poses;
+	};
+
 	DistanceQuery();
+
+	bool readTrajectory(const tinysg::Property& param, std::vector<TrajectoryBody>& bodies, int& numSteps);
+
+	// LinCanny world of the scene this query runs on
+	LinCannyScene* scene;
+
+	// Kept from one execute() to the next so their memory is reused
+	std::vector<TrajectoryBody> trajectory;
+	std::vector<double> savedPoses;
 };
 
 #endif /* DISTANCEQUERY_H_ */
@@ -0,0 +1,46 @@
+/*************************************************************************
+ * SceneML, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * LinCannyScene.cpp
+ *
+ *  Created on: Apr 6, 2009
+ *      Author: yamokosk
+ */
+
+#include "LinCannyScene.h"
+
+const std::string LinCannyScene::Key("LinCanny");
+
+LinCannyScene* LinCannyScene::get(tinysg::SceneContext* context)
+{
+	if ( context == NULL ) return NULL;
+
+	LinCannyScene* scene = static_cast<LinCannyScene*>( context->getPluginData(Key) );
+	if ( scene == NULL )
+	{
+		scene = new LinCannyScene();
+		context->setPluginData(Key, scene);
+	}
+	return scene;
+}
+
+BodyManager* LinCannyScene::getBodyManager(tinysg::SceneContext* context)
+{
+	LinCannyScene* scene = get(context);
+	return ( scene != NULL ) ? &scene->bodies : NULL;
+}
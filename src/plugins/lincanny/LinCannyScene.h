@@ -0,0 +1,61 @@
+/*************************************************************************
+ * SceneML, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * LinCannyScene.h
+ *
+ *  Created on: Apr 6, 2009
+ *      Author: yamokosk
+ */
+
+#ifndef LINCANNYSCENE_H_
+#define LINCANNYSCENE_H_
+
+#include <api/ObjectModel.h>
+
+#include "algorithm/BodyManager.h"
+
+#include <map>
+
+/*
+ * The LinCanny bodies of one scene. Lives in the scene's plugin data, so
+ * every scene has its own BodyManager and independent scenes can compute
+ * distances from different threads.
+ */
+struct LinCannyScene : public tinysg::PluginData
+{
+	//! A body of the BodyManager, as added by a BodyAdapter
+	struct BodyRef
+	{
+		bool critical;
+		int id;
+	};
+	typedef std::map<std::string, BodyRef> BodyMap;
+
+	static const std::string Key;
+
+	//! Returns the LinCannyScene of the scene owning context, creating it on first use.
+	static LinCannyScene* get(tinysg::SceneContext* context);
+	//! Returns the BodyManager of the scene owning context, creating it on first use.
+	static BodyManager* getBodyManager(tinysg::SceneContext* context);
+
+	BodyManager bodies;
+	//! Bodies by the name of the scene object that added them
+	BodyMap names;
+};
+
+#endif /* LINCANNYSCENE_H_ */
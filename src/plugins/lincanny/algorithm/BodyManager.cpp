@@ -1,51 +1,19 @@
 #include "BodyManager.h"
 
-BodyManager& BodyManager::getInstance()
-{
-	static BodyManager instance;
-
-	return instance;
-}
+#include <boost/bind.hpp>
 
 BodyManager::BodyManager(){
 	initialized = 0;
 	critical_count = body_count = 0;
-
-	critical_bodies  = new RigidBody*[MAX_CRITICAL_BODIES];
-	bodies = new RigidBody*[MAX_BODIES];
-
-	distances = new double*[MAX_CRITICAL_BODIES];
-	for(int i=0;i<MAX_CRITICAL_BODIES;i++){
-		distances[i] = new double[MAX_BODIES];
-	}
-
-	critical_points = new VERTEX3D*[MAX_CRITICAL_BODIES];
-	for(int i=0;i<MAX_CRITICAL_BODIES;i++){
-		critical_points[i] = new VERTEX3D[MAX_BODIES];
-	}
-
-	points = new VERTEX3D*[MAX_CRITICAL_BODIES];
-	for(int i=0;i<MAX_CRITICAL_BODIES;i++){
-		points[i] = new VERTEX3D[MAX_BODIES];
-	}
-
-	critical_features = new FEATURE**[MAX_CRITICAL_BODIES];
-	for(int i=0;i<MAX_CRITICAL_BODIES;i++){
-		critical_features[i] = new FEATURE*[MAX_BODIES];
-	}
-
-	critical_groups = new FEATURE**[MAX_CRITICAL_BODIES];
-
-	features = new FEATURE**[MAX_CRITICAL_BODIES];
-	for(int i=0;i<MAX_CRITICAL_BODIES;i++){
-		features[i] = new FEATURE*[MAX_BODIES];
-	}
-
-	body_groups = new FEATURE**[MAX_BODIES];
-
+	warm_critical_count = warm_body_count = 0;
+	num_threads = 1;
+	distance_threshold = DOUBLE_MAX;
+	search_depth = 50;
 }
 
 BodyManager::~BodyManager(){
+	pool.reset();
+
 	for(int i=0;i<body_count;i++){
 		delete bodies[i];
 	}
@@ -53,90 +21,51 @@ BodyManager::~BodyManager(){
 	for(int i=0;i<critical_count;i++){
 		delete critical_bodies[i];
 	}
-
-	for(int i=0;i<critical_count;i++){
-		delete [] distances[i];
-		delete [] critical_points[i];
-		delete [] points[i];
-		delete [] critical_features[i];
-		delete [] features[i];
-	}
-	delete [] critical_features;
-	delete [] features;
-	delete [] critical_points;
-	delete [] points;
-	delete [] distances;
-	delete [] bodies;
-	delete [] critical_bodies;
 }
 
 int BodyManager::addBody(BoundingMesh* mesh)
 {
-	if(body_count == MAX_BODIES){
-		return -1;
-	}
-	bodies[body_count] = new RigidBody();
-	bodies[body_count]->addBoundingMesh(mesh);
-	body_groups[body_count] = new FEATURE*[bodies[body_count]->mesh_count];
-	return body_count++;
+	RigidBody* body = new RigidBody();
+	body->addBoundingMesh(mesh);
+	return addBody(body);
 }
 
 int BodyManager::addBody(BoundingMesh** meshes, int mesh_count)
 {
-	if(body_count == MAX_BODIES){
-		return -1;
-	}
-	bodies[body_count] = new RigidBody();
+	RigidBody* body = new RigidBody();
 	for(int i=0;i<mesh_count;i++){
 		//printf("add\n");
-		bodies[body_count]->addBoundingMesh(meshes[i]);
+		body->addBoundingMesh(meshes[i]);
 	}
-	body_groups[body_count] = new FEATURE*[bodies[body_count]->mesh_count];
-	return body_count++;
+	return addBody(body);
 }
 
 int BodyManager::addBody(RigidBody* body)
 {
-	if(body_count == MAX_BODIES){
-		return -1;
-	}
-	bodies[body_count] = body;
-	body_groups[body_count] = new FEATURE*[bodies[body_count]->mesh_count];
+	bodies.push_back(body);
 	return body_count++;
 }
 
 int BodyManager::addCriticalBody(BoundingMesh* mesh){
-	if(critical_count == MAX_CRITICAL_BODIES){
-		return -1;
-	}
-	critical_bodies[critical_count] = new RigidBody();
-	critical_bodies[critical_count]->addBoundingMesh(mesh);
-	critical_groups[critical_count] = new FEATURE*[critical_bodies[critical_count]->mesh_count];
-	return critical_count++;
+	RigidBody* body = new RigidBody();
+	body->addBoundingMesh(mesh);
+	return addCriticalBody(body);
 }
 
 
 int BodyManager::addCriticalBody(BoundingMesh** meshes, int mesh_count)
 {
-	if(critical_count == MAX_CRITICAL_BODIES){
-		return -1;
-	}
-	critical_bodies[critical_count] = new RigidBody();
+	RigidBody* body = new RigidBody();
 	for(int i=0;i<mesh_count;i++){
 		//printf("add\n");
-		critical_bodies[critical_count]->addBoundingMesh(meshes[i]);
+		body->addBoundingMesh(meshes[i]);
 	}
-	critical_groups[critical_count] = new FEATURE*[critical_bodies[critical_count]->mesh_count];
-	return critical_count++;
+	return addCriticalBody(body);
 }
 
 int BodyManager::addCriticalBody(RigidBody* body)
 {
-	if(critical_count == MAX_CRITICAL_BODIES){
-		return -1;
-	}
-	critical_bodies[critical_count] = body;
-	critical_groups[critical_count] = new FEATURE*[critical_bodies[critical_count]->mesh_count];
+	critical_bodies.push_back(body);
 	return critical_count++;
 }
 
@@ -151,7 +80,7 @@ void BodyManager::setCriticalTransform(int id, double x, double y, double z, dou
 
 void BodyManager::setTransform(int id, double x, double y, double z, double x_rot, double y_rot, double z_rot)
 {
-	if(id < critical_count && id > -1)
+	if(id < body_count && id > -1)
 	{
 		bodies[id]->setTransform(x,y,z,x_rot,y_rot,z_rot);
 	}
@@ -167,38 +96,42 @@ void BodyManager::setCriticalTransform(int id, const double* T)
 
 void BodyManager::setTransform(int id, const double* T)
 {
-	if(id < critical_count && id > -1)
+	if(id < body_count && id > -1)
 	{
 		bodies[id]->setTransform(T);
 	}
 }
 
-double** BodyManager::getDistancesArray(){
-	return distances;
+const double* BodyManager::getDistances() const{
+	return distances.empty() ? NULL : &distances[0];
+}
+
+const FeatureId* BodyManager::getCriticalFeatures() const{
+	return critical_features.empty() ? NULL : &critical_features[0];
 }
 
-FEATURE*** BodyManager::getCriticalFeatureArray(){
-	return critical_features;
+const FeatureId* BodyManager::getFeatures() const{
+	return features.empty() ? NULL : &features[0];
 }
 
-FEATURE*** BodyManager::getFeatureArray(){
-	return features;
+const VERTEX3D* BodyManager::getCriticalPoints() const{
+	return critical_points.empty() ? NULL : &critical_points[0];
 }
 
-VERTEX3D** BodyManager::getCriticalPointArray(){
-	return critical_points;
+const VERTEX3D* BodyManager::getPoints() const{
+	return points.empty() ? NULL : &points[0];
 }
 
-VERTEX3D** BodyManager::getPointArray(){
-	return points;
+const int* BodyManager::getIterations() const{
+	return iterations.empty() ? NULL : &iterations[0];
 }
 
-RigidBody** BodyManager::getCriticalBodyArray(){
-	return critical_bodies;
+RigidBody* BodyManager::getCriticalBody(int id){
+	return critical_bodies[id];
 }
 
-RigidBody** BodyManager::getBodyArray(){
-	return bodies;
+RigidBody* BodyManager::getBody(int id){
+	return bodies[id];
 }
 
 int BodyManager::getCriticalBodyCount(){
@@ -209,73 +142,233 @@ int BodyManager::getBodyCount(){
 	return body_count;
 }
 
+unsigned long BodyManager::getPointLookupCount() const{
+	unsigned long count = 0;
+	for(unsigned int c=0;c<caches.size();c++){
+		count += caches[c].lookup_count;
+	}
+	return count;
+}
 
-bool BodyManager::init()
+unsigned long BodyManager::getPointTransformCount() const{
+	unsigned long count = 0;
+	for(unsigned int c=0;c<caches.size();c++){
+		count += caches[c].transform_count;
+	}
+	return count;
+}
+
+
+void BodyManager::setNumThreads(int n)
+{
+	if(n < 1){
+		n = 1;
+	}
+	if(n == num_threads){
+		return;
+	}
+
+	// A single thread runs the pairs inline, so only keep a pool around when
+	// there is something to share the work with.
+	if(n == 1){
+		pool.reset();
+	}
+	else if(pool.get()){
+		pool->wait();
+		pool->size_controller().resize(n);
+	}
+	else{
+		pool.reset(new boost::threadpool::pool(n));
+	}
+	num_threads = n;
+}
+
+int BodyManager::getNumThreads() const
+{
+	return num_threads;
+}
+
+void BodyManager::setDistanceThreshold(double d)
+{
+	distance_threshold = (d < 0.0) ? 0.0 : d;
+}
+
+double BodyManager::getDistanceThreshold() const
+{
+	return distance_threshold;
+}
+
+void BodyManager::setSearchDepth(int depth)
+{
+	search_depth = (depth < 1) ? 1 : depth;
+}
+
+int BodyManager::getSearchDepth() const
 {
+	return search_depth;
+}
+
+void BodyManager::resetWarmStarts()
+{
+	warm_starts.assign(warm_starts.size(), NO_FEATURE);
+}
+
+void BodyManager::allocatePairs()
+{
+	int pair_count = critical_count*body_count;
+	distances.assign(pair_count, DOUBLE_MAX);
+	critical_points.assign(pair_count, VERTEX3D());
+	points.assign(pair_count, VERTEX3D());
+	critical_features.assign(pair_count, NO_FEATURE);
+	features.assign(pair_count, NO_FEATURE);
+	iterations.assign(pair_count, 0);
+
+	warm_offsets.resize(pair_count + 1);
+
+	int offset = 0;
 	for(int i=0;i<critical_count;i++)
 	{
 		for(int j=0;j<body_count;j++)
 		{
-			double dist;
-			double min_dist = DOUBLE_MAX;
-			VERTEX3D point1, point2;
+			warm_offsets[i*body_count + j] = offset;
+			offset += 2*critical_bodies[i]->mesh_count*bodies[j]->mesh_count;
+		}
+	}
+	warm_offsets[pair_count] = offset;
+
+	// Empty slots are started from scratch by computePair()
+	warm_starts.assign(offset, NO_FEATURE);
+	warm_critical_count = critical_count;
+	warm_body_count = body_count;
+}
+
+void BodyManager::computePair(int i, int j, int depth, PlacedMesh* cache)
+{
+	double dist;
+	double min_dist = DOUBLE_MAX;
+	int steps = 0;
+	VERTEX3D point1, point2;
+	int k = i*body_count + j;
+	int w = warm_offsets[k];
+
+	for(int m=0;m<critical_bodies[i]->mesh_count;m++)
+	{
+		BoundingMesh* mesh1 = critical_bodies[i]->meshes[m];
+		VERTEX3D center1;
+		mesh1->getBoundCenter().transform(critical_bodies[i]->transform, center1);
 
-			for(int m=0;m<critical_bodies[i]->mesh_count;m++)
+		for(int n=0;n<bodies[j]->mesh_count;n++, w += 2)
+		{
+			BoundingMesh* mesh2 = bodies[j]->meshes[n];
+			FeatureId& f1 = warm_starts[w];
+			FeatureId& f2 = warm_starts[w+1];
+			FeatureId closest1 = NO_FEATURE, closest2 = NO_FEATURE;
+
+			// Broad phase. The gap between the bounding spheres never exceeds
+			// the true distance, so beyond the threshold it is reported instead.
+			VERTEX3D center2;
+			mesh2->getBoundCenter().transform(bodies[j]->transform, center2);
+			VERTEX3D axis = center2 - center1;
+			double center_dist = axis.mag();
+			double gap = center_dist - mesh1->getBoundRadius() - mesh2->getBoundRadius();
+
+			if(gap > distance_threshold)
+			{
+				dist = gap;
+				axis = axis / center_dist;
+				point1 = center1 + axis*mesh1->getBoundRadius();
+				point2 = center2 - axis*mesh2->getBoundRadius();
+
+				// The warm start goes stale while the pair is out of range, so
+				// search from scratch once it comes back
+				f1 = f2 = NO_FEATURE;
+			}
+			else
 			{
-				for(int n=0;n<bodies[j]->mesh_count;n++)
+				cache[0].bind(mesh1->getHalfEdgeMesh(), critical_bodies[i]->transform, critical_bodies[i]->generation);
+				cache[1].bind(mesh2->getHalfEdgeMesh(), bodies[j]->transform, bodies[j]->generation);
+
+				int taken = 0;
+				if(f1 == NO_FEATURE || f2 == NO_FEATURE)
+				{
+					dist = closestFeaturesInit(cache[0], cache[1], f1, f2, point1, point2, &taken);
+				}
+				else
 				{
-					dist = closestFeaturesInit(critical_bodies[i]->meshes[m]->getPoly(), bodies[j]->meshes[n]->getPoly(),
-						                       critical_bodies[i]->transform, bodies[j]->transform, critical_groups[i][m], body_groups[j][n],
-										       point1, point2, m);
-
-					if(dist < min_dist)
-					{
-						min_dist = dist;
-						critical_features[i][j] = critical_groups[i][n];
-						features[i][j] = body_groups[j][n];
-						critical_points[i][j] =  point1;
-						points[i][j] = point2;
-					}
+					dist = closestFeatures(cache[0], cache[1], f1, f2, point1, point2, depth, &taken);
 				}
+				steps += taken;
+				closest1 = f1;
+				closest2 = f2;
+			}
+
+			if(dist < min_dist)
+			{
+				min_dist = dist;
+				critical_features[k] = closest1;
+				features[k] = closest2;
+				critical_points[k] = point1;
+				points[k] = point2;
 			}
-			distances[i][j] = min_dist;
 		}
 	}
+	distances[k] = min_dist;
+	iterations[k] = steps;
+}
+
+void BodyManager::computePairRange(int first, int last, PlacedMesh* cache)
+{
+	for(int k=first;k<last;k++)
+	{
+		computePair(k / body_count, k % body_count, search_depth, cache);
+	}
+}
+
+bool BodyManager::init()
+{
+	allocatePairs();
+	if(caches.size() < 2){
+		caches.resize(2);
+	}
+	computePairRange(0, critical_count*body_count, &caches[0]);
 	initialized = 1;
 	return true;
 }
 
 bool BodyManager::computeDistances()
 {
-	for(int i=0;i<critical_count;i++)
+	// Bodies added since the last call have no results or warm starts yet
+	if(!initialized || warm_critical_count != critical_count || warm_body_count != body_count)
 	{
-		for(int j=0;j<body_count;j++)
-		{
-			double dist;
-			double min_dist = DOUBLE_MAX;
-			VERTEX3D point1, point2;
+		allocatePairs();
+	}
 
-			for(int m=0;m<critical_bodies[i]->mesh_count;m++)
-			{
-				for(int n=0;n<bodies[j]->mesh_count;n++)
-				{
-					dist = closestFeatures(critical_bodies[i]->meshes[m]->getPoly(), bodies[j]->meshes[n]->getPoly(),
-						                       critical_bodies[i]->transform, bodies[j]->transform, critical_groups[i][m], body_groups[j][n],
-										       point1, point2, m, 50);
-
-					if(dist < min_dist)
-					{
-						min_dist = dist;
-						critical_features[i][j] = critical_groups[i][m];
-						features[i][j] = body_groups[j][n];
-						critical_points[i][j] = point1;
-						points[i][j] = point2;
-					}
-				}
-			}
-			distances[i][j] = min_dist;
+	int pair_count = critical_count*body_count;
+	if(num_threads < 2 || pair_count < 2)
+	{
+		if(caches.size() < 2){
+			caches.resize(2);
 		}
+		computePairRange(0, pair_count, &caches[0]);
 	}
+	else
+	{
+		// A few chunks per thread evens out pairs that take longer to converge.
+		// Every pair writes only its own results and warm starts, and every
+		// chunk uses its own caches.
+		int chunk_count = (4*num_threads < pair_count) ? 4*num_threads : pair_count;
+		if(caches.size() < (unsigned int)(2*chunk_count)){
+			caches.resize(2*chunk_count);
+		}
+		for(int c=0;c<chunk_count;c++)
+		{
+			int first = (int)((long)pair_count*c/chunk_count);
+			int last = (int)((long)pair_count*(c+1)/chunk_count);
+			boost::threadpool::schedule(*pool, boost::bind(&BodyManager::computePairRange, this, first, last, &caches[2*c]));
+		}
+		pool->wait();
+	}
+
 	initialized = 1;
 	return true;
-}
+}
\ No newline at end of file
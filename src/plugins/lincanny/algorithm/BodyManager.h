@@ -4,17 +4,22 @@
 #include "RigidBody.h"
 #include "IDC.h"
 
-const int MAX_CRITICAL_BODIES = 20;
-const int MAX_BODIES = 20;
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+
+#include "threadpool.hpp"
+
 const double DOUBLE_MAX = 179769313;
 
+// The bodies of one scene and the distances between them. Instances share
+// nothing, so separate scenes can be computed concurrently.
 class BodyManager
 {
 public:
+	BodyManager();
 	~BodyManager();
 
-	static BodyManager& getInstance();
-
 	int addBody(BoundingMesh* mesh);
 	int addBody(BoundingMesh** meshes, int mesh_count);
 	int addBody(RigidBody* body);
@@ -25,6 +30,27 @@ public:
 	bool init();
 	bool computeDistances();
 
+	// Number of threads computeDistances() spreads the body pairs over. Every
+	// pair keeps its own warm start, so the results do not depend on it.
+	void setNumThreads(int n);
+	int getNumThreads() const;
+
+	// Mesh pairs whose bounding spheres are further apart than d skip the
+	// closest feature search. They report the gap between the spheres, a lower
+	// bound on their distance that always exceeds d, with the points on the
+	// spheres and NO_FEATURE. DOUBLE_MAX (the default) turns this off.
+	void setDistanceThreshold(double d);
+	double getDistanceThreshold() const;
+
+	// Most steps the closest feature search of a mesh pair may take from its
+	// warm start, the features of the previous call (default 50). A search
+	// with nothing to start from may always take 400.
+	void setSearchDepth(int depth);
+	int getSearchDepth() const;
+
+	// Makes the next computeDistances() search every pair from scratch
+	void resetWarmStarts();
+
 	//void setCriticalTransform(int id, double* trans);
 	//void setTransform(int id, double* trans);
 	void setCriticalTransform(int id, double x, double y, double z, double x_rot, double y_rot, double z_rot);
@@ -36,29 +62,63 @@ public:
 	int getCriticalBodyCount();
 	int getBodyCount();
 
-	double** getDistancesArray();
-	FEATURE*** getCriticalFeatureArray();
-	FEATURE*** getFeatureArray();
-	VERTEX3D** getCriticalPointArray();
-	VERTEX3D** getPointArray();
-
-	RigidBody** getCriticalBodyArray();
-	RigidBody** getBodyArray();
+	// Results of the last computeDistances(), one entry per body pair stored
+	// row major: pair (i,j) is entry i*getBodyCount() + j. Features belong to
+	// the closest mesh pair, BoundingMesh::getFeature() maps them to the
+	// polyhedron.
+	const double* getDistances() const;
+	const FeatureId* getCriticalFeatures() const;
+	const FeatureId* getFeatures() const;
+	const VERTEX3D* getCriticalPoints() const;
+	const VERTEX3D* getPoints() const;
+	// Steps the closest feature searches of each pair took, summed over its
+	// mesh pairs. Culled mesh pairs take none.
+	const int* getIterations() const;
+
+	RigidBody* getCriticalBody(int id);
+	RigidBody* getBody(int id);
+
+	// Points the closest feature searches needed in world coordinates, and
+	// how many of those had to be transformed rather than read from cache
+	unsigned long getPointLookupCount() const;
+	unsigned long getPointTransformCount() const;
 
 protected:
+	void allocatePairs();
+	void computePair(int i, int j, int depth, PlacedMesh* cache);
+	void computePairRange(int first, int last, PlacedMesh* cache);
+
 	int initialized;
 	int body_count, critical_count;
-	double** distances;
-	RigidBody** critical_bodies, **bodies;
-	FEATURE*** critical_features, ***features;
-	VERTEX3D** critical_points, **points;
-
-	FEATURE*** critical_groups;
-	FEATURE*** body_groups;
+	std::vector<RigidBody*> critical_bodies, bodies;
+
+	// Sized to the pair count by allocatePairs(), indexed i*body_count+j
+	std::vector<double> distances;
+	std::vector<FeatureId> critical_features, features;
+	std::vector<VERTEX3D> critical_points, points;
+	std::vector<int> iterations;
+
+	// Closest features of every mesh pair (m,n) of every body pair (i,j),
+	// critical feature first. Pair (i,j) starts at warm_offsets[i*body_count+j]
+	// and its mesh pairs follow row major, so no two body pairs share a slot.
+	std::vector<FeatureId> warm_starts;
+	std::vector<int> warm_offsets;
+	int warm_critical_count, warm_body_count;
+
+	// Two per chunk of pairs, critical mesh first. Consecutive pairs share
+	// the critical body, and bodies that did not move keep their entries
+	// from one computeDistances() to the next.
+	std::vector<PlacedMesh> caches;
+
+	int num_threads;
+	double distance_threshold;
+	int search_depth;
+	boost::scoped_ptr<boost::threadpool::pool> pool;
 
 private:
-	BodyManager();
+	BodyManager(const BodyManager&);
+	BodyManager& operator=(const BodyManager&);
 };
 
 
-#endif
+#endif
\ No newline at end of file
@@ -1,11 +1,15 @@
 #include "BoundingMesh.h"
 
-BoundingMesh::BoundingMesh()
+BoundingMesh::BoundingMesh() :
+	bound_radius(0.0),
+	use_cache(false)
 {
 }
 
 BoundingMesh::BoundingMesh(const char* f) :
-	filename(f)
+	filename(f),
+	bound_radius(0.0),
+	use_cache(false)
 {
 }
 
@@ -16,23 +20,86 @@ BoundingMesh::~BoundingMesh()
 bool BoundingMesh::load(const char* f)
 {
 	filename = f;
-	mesh.reset( new POLYHEDRON() );
-	if ( importOBJ(filename.c_str(), this->mesh.get()) > 0 )
-		return false;
-	else
-		return true;
+	return load();
 }
 
 bool BoundingMesh::load()
 {
 	mesh.reset( new POLYHEDRON() );
-	if ( importOBJ(filename.c_str(), this->mesh.get()) > 0 )
+	if ( importOBJ(filename.c_str(), this->mesh.get(), &half_edge_mesh, use_cache) != 0 )
 		return false;
-	else
-		return true;
+
+	computeBounds();
+	return true;
 }
 
 POLYHEDRON* BoundingMesh::getPoly()
 {
 	return mesh.get();
 }
+
+void BoundingMesh::setUseCache(bool use)
+{
+	use_cache = use;
+}
+
+bool BoundingMesh::getUseCache() const
+{
+	return use_cache;
+}
+
+const HalfEdgeMesh& BoundingMesh::getHalfEdgeMesh() const
+{
+	return half_edge_mesh;
+}
+
+FEATURE* BoundingMesh::getFeature(FeatureId f)
+{
+	POLYHEDRON* poly = mesh.get();
+	switch ( featureType(f) )
+	{
+		case VERTEX_FEATURE: return poly->vertices[featureIndex(f)];
+		case EDGE_FEATURE: return poly->edges[featureIndex(f)];
+		case FACE_FEATURE: return poly->faces[featureIndex(f)];
+	}
+	return NULL;
+}
+
+const VERTEX3D& BoundingMesh::getBoundCenter() const
+{
+	return bound_center;
+}
+
+double BoundingMesh::getBoundRadius() const
+{
+	return bound_radius;
+}
+
+void BoundingMesh::computeBounds()
+{
+	// Sphere around the centre of the axis aligned box. Not the smallest
+	// sphere, but close for the compact shapes used as bounding meshes.
+	POLYHEDRON* poly = mesh.get();
+	bound_center = VERTEX3D();
+	bound_radius = 0.0;
+	if ( poly->vertex_count < 1 ) return;
+
+	VERTEX3D lo = *poly->vertices[0], hi = *poly->vertices[0];
+	for (int n = 1; n < poly->vertex_count; ++n)
+	{
+		const VERTEX3D* v = poly->vertices[n];
+		if ( v->x < lo.x ) lo.x = v->x;
+		if ( v->y < lo.y ) lo.y = v->y;
+		if ( v->z < lo.z ) lo.z = v->z;
+		if ( v->x > hi.x ) hi.x = v->x;
+		if ( v->y > hi.y ) hi.y = v->y;
+		if ( v->z > hi.z ) hi.z = v->z;
+	}
+	bound_center = VERTEX3D(0.5*(lo.x + hi.x), 0.5*(lo.y + hi.y), 0.5*(lo.z + hi.z));
+
+	for (int n = 0; n < poly->vertex_count; ++n)
+	{
+		double r = (*poly->vertices[n] - bound_center).mag();
+		if ( r > bound_radius ) bound_radius = r;
+	}
+}
@@ -23,6 +23,28 @@ public:
 	bool load();
 	bool load(const char* filename);
 	POLYHEDRON* getPoly();
+
+	// Whether load() keeps a binary copy of the mesh next to the OBJ file
+	// and reuses it while the file is unchanged. Off by default.
+	void setUseCache(bool use);
+	bool getUseCache() const;
+
+	// Compact copy of the polyhedron the distance computations run on, and
+	// the polyhedron feature matching one of its features
+	const HalfEdgeMesh& getHalfEdgeMesh() const;
+	FEATURE* getFeature(FeatureId f);
+
+	// Bounding sphere in mesh coordinates, updated by load()
+	const VERTEX3D& getBoundCenter() const;
+	double getBoundRadius() const;
+
+private:
+	void computeBounds();
+
+	HalfEdgeMesh half_edge_mesh;
+	VERTEX3D bound_center;
+	double bound_radius;
+	bool use_cache;
 };
 
-#endif
+#endif
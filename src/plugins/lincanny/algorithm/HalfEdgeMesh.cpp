@@ -0,0 +1,100 @@
+#include "HalfEdgeMesh.h"
+
+void HalfEdgeMesh::build(const POLYHEDRON& poly)
+{
+	clear();
+
+	vertices.resize(poly.vertex_count);
+	for(int i=0;i<poly.vertex_count;i++)
+	{
+		const VERTEX3D* v = poly.vertices[i];
+		Vertex& out = vertices[i];
+		out.x = v->x;
+		out.y = v->y;
+		out.z = v->z;
+		// Same order as the adjacency list, the search depends on it
+		out.first_edge = (unsigned int)vertex_edges.size();
+		out.edge_count = v->adjacency_size;
+		for(int k=0;k<v->adjacency_size;k++)
+		{
+			vertex_edges.push_back(v->adjacency[k]->index);
+		}
+	}
+
+	edges.resize(poly.edge_count);
+	for(int i=0;i<poly.edge_count;i++)
+	{
+		const EDGE* e = poly.edges[i];
+		Edge& out = edges[i];
+		out.head = e->head->index;
+		out.tail = e->tail->index;
+		// An edge on the rim of an open mesh only has a left face
+		out.left_face = e->left_face->index;
+		out.right_face = e->right_face ? e->right_face->index : out.left_face;
+	}
+
+	const unsigned int none = (unsigned int)-1;
+	std::vector<unsigned int> first_side(poly.edge_count, none);
+
+	faces.resize(poly.face_count);
+	for(int i=0;i<poly.face_count;i++)
+	{
+		const FACE* face = poly.faces[i];
+		Face& out = faces[i];
+		out.n[0] = face->n.x;
+		out.n[1] = face->n.y;
+		out.n[2] = face->n.z;
+		out.d[0] = face->d.x;
+		out.d[1] = face->d.y;
+		out.d[2] = face->d.z;
+		out.first_edge = (unsigned int)half_edges.size();
+		out.edge_count = face->vertex_count;
+
+		// importOBJ() makes face edge j the one between face vertices j and j+1
+		for(int j=0;j<face->vertex_count;j++)
+		{
+			HalfEdge h;
+			h.from = face->vertices[j]->index;
+			h.to = face->vertices[(j+1) % face->vertex_count]->index;
+			h.edge = face->edges[j]->index;
+			h.face = i;
+			h.twin = none;
+
+			unsigned int side = (unsigned int)half_edges.size();
+			unsigned int& other = first_side[h.edge];
+			if(other == none)
+			{
+				other = side;
+			}
+			else
+			{
+				h.twin = other;
+				half_edges[other].twin = side;
+			}
+			half_edges.push_back(h);
+		}
+	}
+
+	// Rim edges of open meshes are their own twin
+	for(unsigned int i=0;i<half_edges.size();i++)
+	{
+		if(half_edges[i].twin == none)
+		{
+			half_edges[i].twin = i;
+		}
+	}
+}
+
+void HalfEdgeMesh::clear()
+{
+	vertices.clear();
+	edges.clear();
+	half_edges.clear();
+	faces.clear();
+	vertex_edges.clear();
+}
+
+bool HalfEdgeMesh::empty() const
+{
+	return vertices.empty();
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef HALFEDGEMESH_H
+#define HALFEDGEMESH_H
+
+#include "Primitive.h"
+
+#include <vector>
+
+// A feature of a HalfEdgeMesh: its type (VERTEX_FEATURE, EDGE_FEATURE or
+// FACE_FEATURE) in the top three bits and its index in the mesh below them.
+typedef unsigned int FeatureId;
+
+const FeatureId NO_FEATURE = 0;
+
+inline FeatureId makeFeature(int type, unsigned int index)
+{
+	return ((FeatureId)type << 29) | index;
+}
+
+inline int featureType(FeatureId f)
+{
+	return (int)(f >> 29);
+}
+
+inline unsigned int featureIndex(FeatureId f)
+{
+	return f & 0x1FFFFFFF;
+}
+
+// Compact copy of a POLYHEDRON for the closest feature search. Features live
+// in contiguous arrays and refer to each other by index, so walking from one
+// feature to its neighbours stays within a few cache lines. Indices match the
+// ones of the POLYHEDRON it was built from.
+class HalfEdgeMesh
+{
+public:
+	struct Vertex
+	{
+		double x, y, z;
+		// Edges meeting at the vertex are vertex_edges[first_edge] onwards
+		unsigned int first_edge, edge_count;
+	};
+
+	struct Edge
+	{
+		unsigned int head, tail;
+		unsigned int left_face, right_face;
+	};
+
+	// One side of an edge, running from -> to in the vertex order of its face
+	struct HalfEdge
+	{
+		unsigned int from, to;
+		unsigned int edge, face;
+		// The other side of the edge
+		unsigned int twin;
+	};
+
+	struct Face
+	{
+		// Unit normal and centroid
+		double n[3], d[3];
+		// Boundary is half_edges[first_edge] onwards, one per face vertex
+		unsigned int first_edge, edge_count;
+	};
+
+	std::vector<Vertex> vertices;
+	std::vector<Edge> edges;
+	std::vector<HalfEdge> half_edges;
+	std::vector<Face> faces;
+	std::vector<unsigned int> vertex_edges;
+
+	void build(const POLYHEDRON& poly);
+	void clear();
+	bool empty() const;
+};
+
+#endif
\ No newline at end of file
@@ -1,65 +1,125 @@
 #ifndef IDC_H
 #define IDC_H
 
-/* 
-IDC(Incremental Distance Calculation): Based on Lin-Canny 
-closest features. See M Lin J Canny, "A fast algorithm for 
-incremental distance calculation," 1991. 
+/*
+IDC(Incremental Distance Calculation): Based on Lin-Canny
+closest features. See M Lin J Canny, "A fast algorithm for
+incremental distance calculation," 1991.
 */
 
-#include "RigidBody.h"
+#include "HalfEdgeMesh.h"
 
 #define EPS 0.000001
 
-double closestFeaturesInit(POLYHEDRON* poly1, POLYHEDRON* poly2, double* poly1_trans, double* poly2_trans, 
-						   FEATURE* &f1, FEATURE* &f2, VERTEX3D &pos1, VERTEX3D &pos2, int debug);
+/*
+A mesh placed in the world by a 4x4 column major transform. World
+coordinates of its vertices and faces are computed the first time they
+are asked for and kept until the mesh or its pose changes: a search
+revisits the same few features many times, and consecutive searches
+often share a mesh. Not thread safe, give every thread its own.
+*/
+class PlacedMesh
+{
+public:
+	PlacedMesh();
+	PlacedMesh(const HalfEdgeMesh& mesh, const double* trans);
+
+	// Places mesh with trans. Coordinates computed earlier are kept as long
+	// as mesh, trans and generation stay the same, so bump generation
+	// whenever the transform changes (see RigidBody).
+	void bind(const HalfEdgeMesh& mesh, const double* trans, unsigned int generation);
+
+	const HalfEdgeMesh& getMesh() const {return *mesh;}
+	const double* getTransform() const {return trans;}
+
+	// References stay valid until the next bind()
+	const VERTEX3D& vertex(unsigned int v)
+	{
+		lookup_count++;
+		if(vertex_stamps[v] != epoch) updateVertex(v);
+		return vertices[v];
+	}
+	const VERTEX3D& faceNormal(unsigned int f)
+	{
+		lookup_count++;
+		if(face_stamps[f] != epoch) updateFace(f);
+		return normals[f];
+	}
+	const VERTEX3D& faceCenter(unsigned int f)
+	{
+		lookup_count++;
+		if(face_stamps[f] != epoch) updateFace(f);
+		return centers[f];
+	}
+
+	// Points asked for and points actually transformed since construction
+	unsigned long lookup_count, transform_count;
+
+private:
+	void updateVertex(unsigned int v);
+	void updateFace(unsigned int f);
+
+	const HalfEdgeMesh* mesh;
+	const double* trans;
+	unsigned int generation;
+
+	// An entry is valid when its stamp equals epoch, so bind() drops all
+	// of them by moving to the next epoch
+	unsigned int epoch;
+	std::vector<unsigned int> vertex_stamps, face_stamps;
+	std::vector<VERTEX3D> vertices, normals, centers;
+};
+
+double closestFeaturesInit(PlacedMesh& mesh1, PlacedMesh& mesh2, FeatureId &f1, FeatureId &f2, VERTEX3D &pos1, VERTEX3D &pos2, int* steps = NULL);
 
 /*
 Call this first time two features are checked
 
-closestFeaturesInit:  Find the closest features between polyhedron 
-rigid bodies. returns: distance between closest features of poly1 
-and poly2.
+closestFeaturesInit:  Find the closest features between polyhedron
+rigid bodies. returns: distance between closest features of mesh1
+and mesh2.
 
 parameters:
-b1, b2: rigid bodies whose distance between closest features 
-is to be computed. 
-f1, f2: address of closest features for b1 and b2, respectively.
-pos1, pos2: the 3D position of the two closest features on b1 
-and b2, respectively. 
+mesh1, mesh2: placed meshes whose distance between closest
+features is to be computed.
+f1, f2: closest features of mesh1 and mesh2, respectively.
+pos1, pos2: the 3D position of the two closest features on mesh1
+and mesh2, respectively.
+steps: if given, set to the number of steps the search took, at most
+depth.
+
+closestFeatures: Same, starting from the closest features f1, f2
+of an earlier call. Gives up after depth steps.
 */
 
-double closestFeatures(POLYHEDRON* poly1, POLYHEDRON* poly2, double* poly1_trans, double* poly2_trans, 
-				       FEATURE* &f1, FEATURE* &f2, VERTEX3D &pos1, VERTEX3D &pos2, int debug, int depth);
-
-
-
+double closestFeatures(PlacedMesh& mesh1, PlacedMesh& mesh2, FeatureId &f1, FeatureId &f2, VERTEX3D &pos1, VERTEX3D &pos2, int depth, int* steps = NULL);
 
 
+/*
+Closest feature tests. p is a point in world coordinates, all other
+features belong to the mesh they follow. Each returns true when its
+last feature is the closest one to the first, otherwise f is set to
+a neighbouring feature that is closer.
+*/
 
-bool point_vertex(VERTEX3D* p, VERTEX3D* v, double* p_trans, double* e_trans, FEATURE* &f);
-bool point_edge(VERTEX3D* p, EDGE* e, double* p_trans, double* e_trans, FEATURE* &f);
-bool point_face(VERTEX3D* p, FACE* face, double* p_trans, double* face_trans, FEATURE* &f);
-bool edge_edge(EDGE* e1, EDGE* e2, double* e1_trans, double* e2_trans, FEATURE* &f);
-bool edge_face(EDGE* edge, FACE* face, double* edge_trans, double* face_trans, FEATURE* &f);
-bool face_edge(FACE* face, EDGE* edge, double* face_trans, double* edge_trans, FEATURE* &f);
-bool face_face(FACE* face1, FACE* face2, double* face1_trans, double* face2_trans, FEATURE* &f);
-
-bool confirmClosest(FEATURE* f1, FEATURE* f2, double* f1_trans, double* f2_trans);
-
-bool pointInFrontOfPlane(VECTOR3D pos, VECTOR3D n, VERTEX3D p);
-bool parallelEdgeFace(EDGE* e, FACE* f , double* e_trans, double* f_trans);
-bool parallelFaceFace(FACE* face1, FACE* face2, double* face1_trans, double* face2_trans);
-bool overlapTest(FACE* f1, FACE* f2, double* f1_trans, double* f2_trans, FEATURE* &f);
-bool edgeVisible(EDGE* e, VERTEX3D* p, double* e_trans, double* p_trans,int &face_id);
-
-double closestPointEdge(VERTEX3D* p, EDGE* f, double* p_trans, double* e_trans, VERTEX3D &v);
-double closestPointFace(VERTEX3D* p, FACE* f, double* p_trans, double* f_trans, VERTEX3D &v);
-double closestEdgeEdge(EDGE* e1, EDGE* e2, double* e1_trans, double* e2_trans,  VERTEX3D &v1, VERTEX3D &v2);
-double closestEdgeEdgeDraw(EDGE* e1, EDGE* e2, double* e1_trans, double* e2_trans,  VERTEX3D &v1, VERTEX3D &v2, int& segment_id);
-double closestFaceFace(FACE* f1, FACE* f2, double* f1_trans, double* f2_trans,  VERTEX3D &v1, VERTEX3D &v2);
-
-VERTEX3D closestEdgeFace(EDGE* e, FACE* f, double* e_trans, double* f_trans);
-VERTEX3D closestFaceFace(FACE* f1, FACE* f2, double* f1_trans, double* f2_trans);
+bool point_vertex(const VERTEX3D& p, PlacedMesh& m, unsigned int v, FeatureId &f);
+bool point_edge(const VERTEX3D& p, PlacedMesh& m, unsigned int e, FeatureId &f);
+bool point_face(const VERTEX3D& p, PlacedMesh& m, unsigned int face, FeatureId &f, int& turn);
+bool edge_edge(PlacedMesh& m1, unsigned int e1, PlacedMesh& m2, unsigned int e2, FeatureId &f);
+bool edge_face(PlacedMesh& m1, unsigned int edge, PlacedMesh& m2, unsigned int face, FeatureId &f, int& turn);
+bool face_edge(PlacedMesh& m1, unsigned int face, PlacedMesh& m2, unsigned int edge, FeatureId &f, int& turn);
+bool face_face(PlacedMesh& m1, unsigned int face1, PlacedMesh& m2, unsigned int face2, FeatureId &f, int& turn);
+
+bool confirmClosest(PlacedMesh& m1, FeatureId f1, PlacedMesh& m2, FeatureId f2, int& turn);
+
+bool pointInFrontOfPlane(const VECTOR3D& pos, const VECTOR3D& n, const VERTEX3D& p);
+bool parallelEdgeFace(PlacedMesh& m1, unsigned int e, PlacedMesh& m2, unsigned int f);
+bool parallelFaceFace(PlacedMesh& m1, unsigned int face1, PlacedMesh& m2, unsigned int face2);
+bool overlapTest(PlacedMesh& m1, unsigned int f1, PlacedMesh& m2, unsigned int f2, FeatureId &f, int& turn);
+bool edgeVisible(PlacedMesh& m, unsigned int e, const VERTEX3D& p);
+
+double closestPointEdge(const VERTEX3D& p, PlacedMesh& m, unsigned int e, VERTEX3D &v);
+double closestPointFace(const VERTEX3D& p, PlacedMesh& m, unsigned int f, VERTEX3D &v);
+double closestEdgeEdge(PlacedMesh& m1, unsigned int e1, PlacedMesh& m2, unsigned int e2, VERTEX3D &v1, VERTEX3D &v2);
 
 #endif
\ No newline at end of file
@@ -2,187 +2,409 @@
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 //#define BUG_importOBJ
 
-int importOBJ(const char* filename, POLYHEDRON* mesh){
+// Mesh topology in flat arrays, either parsed from the OBJ file or read
+// from its cache. Face f has face_sizes[f] corners. Taking the corners of
+// all faces in order, corner k is vertex face_vertices[k] and face_edges[k]
+// is the edge from it to the next corner of its face. Edges are numbered in
+// the order the faces first use them.
+struct MeshArrays{
+	int vertex_count, face_count, corner_count, edge_count;
+	const double* coords;
+	const int* face_sizes;
+	const int* face_vertices;
+	const int* face_edges;
+	// Head and tail vertex of every edge
+	const int* edges;
+};
 
-	// Open the file
-	std::fstream file;
-	file.open(filename, std::ios_base::in);
+struct ParsedMesh{
+	std::vector<double> coords;
+	std::vector<int> face_sizes;
+	std::vector<int> face_vertices;
+	std::vector<int> face_edges;
+	std::vector<int> edges;
+};
 
-	if( !file.good() )
-	{
-		file.close();
-		std::cerr << "File \"" << filename << "\" not found." << std::endl;
-		return -1;
-	}
+// Layout of a cache file: the header, then the arrays of MeshArrays in the
+// order they are declared there. Written in native byte order.
+struct CacheHeader{
+	char magic[8];
+	// Size and modification time of the OBJ file the cache was built from
+	long long source_size;
+	long long source_time;
+	int byte_order;
+	int vertex_count, face_count, corner_count, edge_count;
+	int unused;
+};
 
-	//collect number of features of the polyhedron
-	mesh->vertex_count = 0;
-	mesh->face_count = 0;
-	mesh->edge_count = 0;
-	char buf[256];
-	while( !file.eof() )
-	{
-		file.getline(buf,sizeof(buf));
-		switch(buf[0])
-		{
-			case 'v': {
-				if(buf[1] == ' ') mesh->vertex_count++;
-				break;
+// Change the last two characters whenever the layout changes
+static const char CACHE_MAGIC[8] = {'L','C','M','E','S','H','0','1'};
+static const int CACHE_BYTE_ORDER = 0x01020304;
+
+template<class T>
+static const T* arrayOf(const std::vector<T>& v){
+	return v.empty() ? NULL : &v[0];
+}
+
+// Edges keyed by their unordered vertex pair, so finding the edge of a face
+// side takes the same time however many edges the mesh already has
+class EdgeMap{
+public:
+	EdgeMap() : slots(1024, -1) {}
+
+	// Index of the edge between a and b, which is appended to edges (as head
+	// a and tail b) if it is new
+	int find(int a, int b, std::vector<int>& edges){
+		if(2*(edges.size()/2 + 1) > slots.size()){
+			grow(edges);
+		}
+		unsigned int mask = (unsigned int)slots.size() - 1;
+		for(unsigned int s = hash(a, b) & mask; ; s = (s + 1) & mask){
+			int e = slots[s];
+			if(e < 0){
+				slots[s] = (int)edges.size()/2;
+				edges.push_back(a);
+				edges.push_back(b);
+				return slots[s];
 			}
-			case 'f': {
-				if(buf[1] == ' ') mesh->face_count++;
-				break;
+			if((edges[2*e] == a && edges[2*e+1] == b) || (edges[2*e] == b && edges[2*e+1] == a)){
+				return e;
 			}
-			default:
-				break;
 		}
 	}
-	file.clear();              // forget we hit the end of file
-	file.seekg(0, std::ios::beg);   // move to the start of the file
 
-	//fill feature arrays
-	mesh->vertices = new VERTEX3D*[mesh->vertex_count];
-	mesh->faces = new FACE*[mesh->face_count];
-	int edge_count = mesh->face_count + mesh->vertex_count - 2; //Euler's formula
-	mesh->edges = new EDGE*[edge_count];
+private:
+	static unsigned int hash(int a, int b){
+		unsigned int lo = (unsigned int)(a < b ? a : b);
+		unsigned int hi = (unsigned int)(a < b ? b : a);
+		return (lo * 2654435761u) ^ (hi * 40503u);
+	}
 
-#ifdef BUG_importOBJ
-	std::cout << "Faces: " << mesh->face_count << ", Vertices: " << mesh->vertex_count << std::endl;
-#endif
+	void grow(const std::vector<int>& edges){
+		slots.assign(2*slots.size(), -1);
+		unsigned int mask = (unsigned int)slots.size() - 1;
+		for(int e=0;e<(int)edges.size()/2;e++){
+			unsigned int s = hash(edges[2*e], edges[2*e+1]) & mask;
+			while(slots[s] >= 0) s = (s + 1) & mask;
+			slots[s] = e;
+		}
+	}
 
-	int v = 0;
-	int f = 0;
-	double vbuf[3] = {0.0, 0.0, 0.0};
-	while( !file.eof() )
-	{
-		file.getline(buf,sizeof(buf));
-		switch (buf[0])
-		{
-			case 'v':
-			{
-				if(buf[1] == ' ')
-				{
-					sscanf( (buf+2), "%lf %lf %lf", vbuf, vbuf+1, vbuf+2);
-#ifdef BUG_importOBJ
-					std::cout << "Case 'v': " << vbuf[0] << ", " << vbuf[1] << ", " << vbuf[2] << std::endl;
-#endif
-					mesh->vertices[v] = new VERTEX3D(vbuf[0],vbuf[1],vbuf[2]);
-					mesh->vertices[v]->index = v;
-					v++;
+	// Kept at most half full
+	std::vector<int> slots;
+};
+
+static const char* skipSpaces(const char* p){
+	while(*p == ' ' || *p == '\t' || *p == '\r') p++;
+	return p;
+}
+
+static const char* nextLine(const char* p){
+	while(*p != '\0' && *p != '\n') p++;
+	return (*p == '\0') ? p : p+1;
+}
+
+// Parses the text of an OBJ file in one pass. Only v and f lines are used.
+static int parseOBJ(const char* text, const char* filename, ParsedMesh& out){
+	EdgeMap edge_map;
+	int line_number = 0;
+	for(const char* p = text; *p != '\0'; p = nextLine(p)){
+		line_number++;
+		p = skipSpaces(p);
+		if(p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')){
+			const char* q = p+2;
+			for(int k=0;k<3;k++){
+				char* end;
+				double x = strtod(q, &end);
+				if(end == q){
+					std::cerr << filename << ":" << line_number << ": vertex needs three coordinates." << std::endl;
+					return -1;
 				}
-				break;
+				out.coords.push_back(x);
+				q = end;
 			}
-			case 'f':
-			{
-				if(buf[1] == ' ')
-				{
-					unsigned int ids[4] = {0, 0, 0};
-					char *tok; unsigned int nverts = 0;
-					tok = strtok((buf+2)," ");
-					while (tok != NULL)
-					{
-						if ( nverts > 3 )
-						{
-							file.close();
-							std::cerr << "There is an problem with the faces in the obj file. please use quads or triangles only: exiting import routine" << std::endl;
-							return -1;
-						}
-
-						char *tmp = NULL, index[10];
-						if ( (tmp = strstr(tok, "/")) != NULL )
-						{
-							// A slash was found. Just need to extract the first digit
-							memset(index, '\0', sizeof(index));
-							memcpy(index, tok, (tmp - tok)*sizeof(char));
-							ids[nverts] = atoi(index)-1;
-							nverts++;
-						} else {
-							// No slash was found. Just process as if it is a number
-							ids[nverts] = atoi(index)-1;
-							nverts++;
-						}
-						tok = strtok(NULL, " ");
-					}
-
-#ifdef BUG_importOBJ
-					std::cout << "Case 'f' (" << nverts << "): " << ids[0] << ", " << ids[1] << ", " << ids[2] << ", " << ids[4] << std::endl;
-#endif
-					int v1 = ids[0];
-					int v2 = ids[1];
-					int v3 = ids[2];
-					int v4 = ids[3];
-
-					if( nverts == 3 )
-					{
-						//triangle
-						EDGE* e1 = addEdge(mesh, v1, v2);
-						EDGE* e2 = addEdge(mesh, v2, v3);
-						EDGE* e3 = addEdge(mesh, v3, v1);
-
-						mesh->vertices[v1]->addToAdjacency(e1);
-						mesh->vertices[v1]->addToAdjacency(e3);
-
-						mesh->vertices[v2]->addToAdjacency(e1);
-						mesh->vertices[v2]->addToAdjacency(e2);
-
-						mesh->vertices[v3]->addToAdjacency(e2);
-						mesh->vertices[v3]->addToAdjacency(e3);
-
-						mesh->faces[f] = new FACE(mesh->vertices[v1],mesh->vertices[v2],mesh->vertices[v3], e1, e2, e3);
-					}
-					else
-					{
-						//quad
-						EDGE* e1 = addEdge(mesh, v1, v2);
-						EDGE* e2 = addEdge(mesh, v2, v3);
-						EDGE* e3 = addEdge(mesh, v3, v4);
-						EDGE* e4 = addEdge(mesh, v4, v1);
-
-						mesh->vertices[v1]->addToAdjacency(e1);
-						mesh->vertices[v1]->addToAdjacency(e4);
-
-						mesh->vertices[v2]->addToAdjacency(e1);
-						mesh->vertices[v2]->addToAdjacency(e2);
-
-						mesh->vertices[v3]->addToAdjacency(e2);
-						mesh->vertices[v3]->addToAdjacency(e3);
-
-						mesh->vertices[v4]->addToAdjacency(e3);
-						mesh->vertices[v4]->addToAdjacency(e4);
-
-
-						mesh->faces[f] = new FACE(mesh->vertices[v1],mesh->vertices[v2],mesh->vertices[v3],mesh->vertices[v4], e1, e2, e3, e4);
-					}
-					mesh->faces[f]->index = f;
-					f++;
+		}
+		else if(p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')){
+			int vertex_count = (int)out.coords.size()/3;
+			int ids[4];
+			int nverts = 0;
+			for(const char* q = skipSpaces(p+2); *q != '\0' && *q != '\n' && *q != '#'; q = skipSpaces(q)){
+				char* end;
+				long id = strtol(q, &end, 10);
+				if(end == q){
+					std::cerr << filename << ":" << line_number << ": face vertex is not a number." << std::endl;
+					return -1;
 				}
-				break;
+				if(nverts == 4){
+					std::cerr << "There is an problem with the faces in the obj file. please use quads or triangles only: exiting import routine" << std::endl;
+					return -1;
+				}
+				// Negative indices count back from the last vertex read
+				id = (id < 0) ? vertex_count + id : id - 1;
+				if(id < 0 || id >= vertex_count){
+					std::cerr << filename << ":" << line_number << ": face uses a vertex that does not exist." << std::endl;
+					return -1;
+				}
+				ids[nverts++] = (int)id;
+
+				// Skip texture and normal indices (v/t, v//n or v/t/n)
+				q = end;
+				while(*q != '\0' && *q != ' ' && *q != '\t' && *q != '\r' && *q != '\n') q++;
+			}
+			if(nverts < 3){
+				std::cerr << filename << ":" << line_number << ": face needs at least three vertices." << std::endl;
+				return -1;
+			}
+
+			out.face_sizes.push_back(nverts);
+			for(int k=0;k<nverts;k++){
+				out.face_vertices.push_back(ids[k]);
+				out.face_edges.push_back(edge_map.find(ids[k], ids[(k+1) % nverts], out.edges));
 			}
-			default:
-				break;
 		}
 	}
-
-	//close file
-	file.close();
 	return 0;
 }
 
+// Checks what buildPolyhedron() relies on, so that a damaged cache is
+// rejected rather than crashing the import
+static bool checkArrays(const MeshArrays& a){
+	int c = 0;
+	int next_edge = 0;
+	for(int f=0;f<a.face_count;f++){
+		int n = a.face_sizes[f];
+		if(n < 3 || n > 4 || c + n > a.corner_count) return false;
+		for(int k=0;k<n;k++,c++){
+			if(a.face_vertices[c] < 0 || a.face_vertices[c] >= a.vertex_count) return false;
+			if(a.face_edges[c] < 0 || a.face_edges[c] > next_edge) return false;
+			if(a.face_edges[c] == next_edge) next_edge++;
+		}
+	}
+	if(c != a.corner_count || next_edge != a.edge_count) return false;
+	for(int e=0;e<2*a.edge_count;e++){
+		if(a.edges[e] < 0 || a.edges[e] >= a.vertex_count) return false;
+	}
+	return true;
+}
+
+// Creates the features of mesh in the same order, and with the same
+// adjacency lists, as reading the faces one after another always did
+static void buildPolyhedron(const MeshArrays& a, POLYHEDRON* mesh){
+	mesh->vertex_count = a.vertex_count;
+	mesh->face_count = a.face_count;
+	mesh->edge_count = 0;
+	mesh->vertices = new VERTEX3D*[a.vertex_count];
+	mesh->faces = new FACE*[a.face_count];
+	mesh->edges = new EDGE*[a.edge_count];
+
+	for(int v=0;v<a.vertex_count;v++){
+		mesh->vertices[v] = new VERTEX3D(a.coords[3*v], a.coords[3*v+1], a.coords[3*v+2]);
+		mesh->vertices[v]->index = v;
+	}
+
+	const int* corner = a.face_vertices;
+	const int* side = a.face_edges;
+	for(int f=0;f<a.face_count;f++){
+		int n = a.face_sizes[f];
+		VERTEX3D* v[4];
+		EDGE* e[4];
+		for(int k=0;k<n;k++){
+			v[k] = mesh->vertices[corner[k]];
+			if(side[k] == mesh->edge_count){
+				EDGE* edge = new EDGE(mesh->vertices[a.edges[2*side[k]]], mesh->vertices[a.edges[2*side[k]+1]]);
+				mesh->edges[mesh->edge_count] = edge;
+				edge->index = mesh->edge_count++;
+			}
+			e[k] = mesh->edges[side[k]];
+		}
+
+		// Each corner is adjacent to the edges before and after it
+		v[0]->addToAdjacency(e[0]);
+		v[0]->addToAdjacency(e[n-1]);
+		for(int k=1;k<n;k++){
+			v[k]->addToAdjacency(e[k-1]);
+			v[k]->addToAdjacency(e[k]);
+		}
 
-EDGE* addEdge(POLYHEDRON* mesh,int head_index,int tail_index){
-	for(int i=0;i<mesh->edge_count;i++){
-		if((mesh->edges[i]->head->index == head_index) && (mesh->edges[i]->tail->index == tail_index) ){
-			return mesh->edges[i];
+		if(n == 3){
+			mesh->faces[f] = new FACE(v[0], v[1], v[2], e[0], e[1], e[2]);
 		}
-		else if((mesh->edges[i]->head->index == tail_index) && (mesh->edges[i]->tail->index == head_index)){
-			return mesh->edges[i];
+		else{
+			mesh->faces[f] = new FACE(v[0], v[1], v[2], v[3], e[0], e[1], e[2], e[3]);
 		}
+		mesh->faces[f]->index = f;
+
+		corner += n;
+		side += n;
+	}
+
+#ifdef BUG_importOBJ
+	std::cout << "Faces: " << mesh->face_count << ", Vertices: " << mesh->vertex_count << ", Edges: " << mesh->edge_count << std::endl;
+#endif
+}
+
+static bool sourceStamp(const char* filename, long long& size, long long& time){
+	struct stat info;
+	if(stat(filename, &info) != 0){
+		return false;
+	}
+	size = (long long)info.st_size;
+	time = (long long)info.st_mtime;
+	return true;
+}
+
+// Reads a whole file into buffer, which is made of doubles so that the
+// coordinates in it are aligned
+static bool readFile(const std::string& filename, std::vector<double>& buffer, size_t& bytes){
+	std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+	if(!in){
+		return false;
+	}
+	bytes = (size_t)in.tellg();
+	in.seekg(0, std::ios::beg);
+	buffer.resize((bytes + sizeof(double) - 1)/sizeof(double));
+	if(bytes > 0){
+		in.read(reinterpret_cast<char*>(&buffer[0]), bytes);
+	}
+	return !in.fail();
+}
+
+static bool loadCache(const std::string& cachename, long long size, long long time, POLYHEDRON* mesh){
+	std::vector<double> buffer;
+	size_t bytes = 0;
+	if(!readFile(cachename, buffer, bytes) || bytes < sizeof(CacheHeader)){
+		return false;
+	}
+	const char* data = reinterpret_cast<const char*>(&buffer[0]);
+
+	CacheHeader header;
+	memcpy(&header, data, sizeof(header));
+	if(memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.byte_order != CACHE_BYTE_ORDER ||
+	   header.source_size != size || header.source_time != time){
+		return false;
+	}
+	if(header.vertex_count < 0 || header.face_count < 0 || header.corner_count < 0 || header.edge_count < 0){
+		return false;
+	}
+	size_t expected = sizeof(header) + 3*sizeof(double)*header.vertex_count +
+		sizeof(int)*(header.face_count + 2*header.corner_count + 2*header.edge_count);
+	if(bytes != expected){
+		return false;
+	}
+
+	// The header keeps the coordinates 8 byte aligned in the buffer
+	MeshArrays a;
+	a.vertex_count = header.vertex_count;
+	a.face_count = header.face_count;
+	a.corner_count = header.corner_count;
+	a.edge_count = header.edge_count;
+	a.coords = reinterpret_cast<const double*>(data + sizeof(header));
+	a.face_sizes = reinterpret_cast<const int*>(a.coords + 3*a.vertex_count);
+	a.face_vertices = a.face_sizes + a.face_count;
+	a.face_edges = a.face_vertices + a.corner_count;
+	a.edges = a.face_edges + a.corner_count;
+	if(!checkArrays(a)){
+		return false;
+	}
+
+	buildPolyhedron(a, mesh);
+	return true;
+}
+
+// Failing to write the cache is not an error, the next import just parses
+// the OBJ file again
+static void writeCache(const std::string& cachename, long long size, long long time, const MeshArrays& a){
+	CacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.source_size = size;
+	header.source_time = time;
+	header.byte_order = CACHE_BYTE_ORDER;
+	header.vertex_count = a.vertex_count;
+	header.face_count = a.face_count;
+	header.corner_count = a.corner_count;
+	header.edge_count = a.edge_count;
+
+	// Written aside and renamed, so a reader never sees half a cache
+	std::string tmpname = cachename + ".tmp";
+	std::ofstream out(tmpname.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if(!out){
+		return;
 	}
-	EDGE* e = new EDGE(mesh->vertices[head_index], mesh->vertices[tail_index]);
-	mesh->edges[mesh->edge_count] = e;
-	mesh->edges[mesh->edge_count]->index = mesh->edge_count++;
-	return e;
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(a.coords), 3*sizeof(double)*a.vertex_count);
+	out.write(reinterpret_cast<const char*>(a.face_sizes), sizeof(int)*a.face_count);
+	out.write(reinterpret_cast<const char*>(a.face_vertices), sizeof(int)*a.corner_count);
+	out.write(reinterpret_cast<const char*>(a.face_edges), sizeof(int)*a.corner_count);
+	out.write(reinterpret_cast<const char*>(a.edges), 2*sizeof(int)*a.edge_count);
+	out.close();
+
+	remove(cachename.c_str());
+	if(out.fail() || rename(tmpname.c_str(), cachename.c_str()) != 0){
+		remove(tmpname.c_str());
+	}
+}
+
+std::string objCacheName(const char* filename){
+	return std::string(filename) + ".lcmesh";
+}
+
+int importOBJ(const char* filename, POLYHEDRON* mesh, HalfEdgeMesh* compact, bool use_cache){
+
+	long long size = 0, time = 0;
+	std::string cachename = objCacheName(filename);
+	if(use_cache && sourceStamp(filename, size, time) && loadCache(cachename, size, time, mesh)){
+		if(compact){
+			compact->build(*mesh);
+		}
+		return 0;
+	}
+
+	// Read the whole file at once, zero terminated for the parser
+	std::ifstream file(filename, std::ios::in | std::ios::binary);
+	if( !file.good() )
+	{
+		std::cerr << "File \"" << filename << "\" not found." << std::endl;
+		return -1;
+	}
+	std::vector<char> text;
+	file.seekg(0, std::ios::end);
+	text.resize((size_t)file.tellg() + 1);
+	file.seekg(0, std::ios::beg);
+	file.read(&text[0], text.size() - 1);
+	text[text.size() - 1] = '\0';
+	file.close();
+
+	ParsedMesh parsed;
+	if(parseOBJ(&text[0], filename, parsed) != 0){
+		return -1;
+	}
+
+	MeshArrays a;
+	a.vertex_count = (int)parsed.coords.size()/3;
+	a.face_count = (int)parsed.face_sizes.size();
+	a.corner_count = (int)parsed.face_vertices.size();
+	a.edge_count = (int)parsed.edges.size()/2;
+	a.coords = arrayOf(parsed.coords);
+	a.face_sizes = arrayOf(parsed.face_sizes);
+	a.face_vertices = arrayOf(parsed.face_vertices);
+	a.face_edges = arrayOf(parsed.face_edges);
+	a.edges = arrayOf(parsed.edges);
+	buildPolyhedron(a, mesh);
+
+	if(use_cache && size > 0){
+		writeCache(cachename, size, time, a);
+	}
+
+	if(compact){
+		compact->build(*mesh);
+	}
+	return 0;
 }
@@ -2,9 +2,14 @@
 #define OBJIMPORT_H
 
 #include <stdio.h>
+#include <string>
 #include "Primitive.h"
+#include "HalfEdgeMesh.h"
 
-int importOBJ(const char* filename, POLYHEDRON* mesh);
-EDGE* addEdge(POLYHEDRON* mesh, int head_index, int tail_index);
+// Also builds compact from the imported mesh when given. With use_cache the
+// topology is also written to objCacheName(filename), and later imports of
+// the unchanged file read that instead of parsing the text again.
+int importOBJ(const char* filename, POLYHEDRON* mesh, HalfEdgeMesh* compact = NULL, bool use_cache = false);
+std::string objCacheName(const char* filename);
 
 #endif
@@ -161,7 +161,6 @@ FACE::FACE(VERTEX3D* v1,VERTEX3D* v2,VERTEX3D* v3,VERTEX3D* v4,EDGE* e1,EDGE* e2
 	this->vertex_count = 4;
 	this->vertices = new VERTEX3D*[this->vertex_count];
 	this->edges = new EDGE*[this->vertex_count];
-	this->idc_edge = 0;
 	vertices[0] = v1;
 	vertices[1] = v2;
 	vertices[2] = v3;
@@ -197,7 +196,6 @@ FACE::FACE(VERTEX3D* v1,VERTEX3D* v2,VERTEX3D* v3,EDGE* e1,EDGE* e2,EDGE* e3):FE
 	this->vertex_count = 3;
 	this->vertices = new VERTEX3D*[this->vertex_count];
 	this->edges = new EDGE*[this->vertex_count];
-	this->idc_edge = 0;
 	vertices[0] = v1;
 	vertices[1] = v2;
 	vertices[2] = v3;
@@ -258,6 +256,9 @@ POLYHEDRON::POLYHEDRON(){
 	this->vertex_count = 0;
 	this->edge_count = 0;
 	this->face_count = 0;
+	this->vertices = NULL;
+	this->edges = NULL;
+	this->faces = NULL;
 }
 
 POLYHEDRON::~POLYHEDRON(){
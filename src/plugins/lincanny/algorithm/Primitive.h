@@ -117,7 +117,6 @@ public:
 	int index;
 	int vertex_count;
 	
-	mutable int idc_edge;
 	VERTEX3D n;
 	VERTEX3D d;
 	EDGE** edges;
@@ -5,6 +5,7 @@ RigidBody::RigidBody(){
 	mesh_count = 0;
 	max_meshes = 5;
 	meshes = new BoundingMesh*[max_meshes];
+	generation = 0;
 	resetTransform();	
 }
 
@@ -26,6 +27,7 @@ void RigidBody::resetTransform(){
 			}
 		}
 	}
+	generation++;
 }
 
 void RigidBody::addBoundingMesh(BoundingMesh* mesh){
@@ -82,9 +84,11 @@ void RigidBody::setTransform(double x, double y, double z, double x_rot, double
 	transform[13] = y;
 	transform[14] = z;
 	transform[15] = 1;
+	generation++;
 }
 
 void RigidBody::setTransform(const double* T)
 {
 	memcpy(transform, T, sizeof(double)*16);
+	generation++;
 }
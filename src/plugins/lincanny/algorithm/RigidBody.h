@@ -12,6 +12,9 @@ public:
 	int max_meshes;
 	BoundingMesh** meshes;
 	double transform[16];
+	// Bumped by every change to transform, so cached world coordinates
+	// of the meshes can tell they are stale
+	unsigned int generation;
 	
 	RigidBody();
 	~RigidBody();
@@ -0,0 +1,219 @@
+/*
+ * QueryAllocationTest.cpp
+ *
+ *  Created on: Apr 22, 2009
+ *      Author: yamokosk
+ */
+
+#include <cppunit/config/SourcePrefix.h>
+#include "QueryAllocationTest.h"
+
+#include <plugins/lincanny/LinCannyScene.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+
+using namespace log4cxx;
+using namespace tinysg;
+
+LoggerPtr QueryAllocationTest::logger(Logger::getLogger("QueryAllocationTest"));
+
+CPPUNIT_TEST_SUITE_REGISTRATION( QueryAllocationTest );
+
+const int QueryAllocationTest::NumBodies(3);
+
+// Every allocation of the test program is counted here
+static unsigned long g_allocations = 0;
+
+void* operator new(std::size_t size)
+{
+	++g_allocations;
+	void* p = std::malloc( (size > 0) ? size : 1 );
+	if ( p == NULL ) throw std::bad_alloc();
+	return p;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* p) throw()
+{
+	std::free(p);
+}
+
+void operator delete[](void* p) throw()
+{
+	std::free(p);
+}
+
+static int ignoreService(const char*, void*)
+{
+	return 0;
+}
+
+static void writeVertex(std::ofstream& out, double x, double y, double z)
+{
+	out << "v " << x << " " << y << " " << z << "\n";
+	out << "vn " << x << " " << y << " " << z << "\n";
+}
+
+static void writeFace(std::ofstream& out, int a, int b, int c)
+{
+	out << "f " << a << "//" << a << " " << b << "//" << b << " " << c << "//" << c << "\n";
+}
+
+// Closed triangulated unit sphere, so every body is a valid convex polyhedron.
+// On a unit sphere the vertex normals are the vertices themselves.
+static void writeSphere(const char* filename, int slices, int stacks)
+{
+	std::ofstream out(filename);
+
+	writeVertex(out, 0.0, 0.0, 1.0);
+	for (int s = 1; s < stacks; ++s)
+	{
+		double phi = M_PI * s / stacks;
+		for (int k = 0; k < slices; ++k)
+		{
+			double theta = 2.0 * M_PI * k / slices;
+			writeVertex(out, std::sin(phi) * std::cos(theta), std::sin(phi) * std::sin(theta), std::cos(phi));
+		}
+	}
+	writeVertex(out, 0.0, 0.0, -1.0);
+
+	// OBJ indices start at one; ring r (0 based) starts at 2 + r * slices
+	int bottom = 2 + (stacks - 1) * slices;
+	for (int k = 0; k < slices; ++k)
+	{
+		int k1 = (k + 1) % slices;
+		writeFace(out, 1, 2 + k, 2 + k1);
+		for (int r = 0; r + 1 < stacks - 1; ++r)
+		{
+			int a = 2 + r * slices, b = a + slices;
+			writeFace(out, a + k, b + k, b + k1);
+			writeFace(out, a + k, b + k1, a + k1);
+		}
+		writeFace(out, bottom, bottom - slices + k1, bottom - slices + k);
+	}
+}
+
+QueryAllocationTest::Context::~Context()
+{
+	std::map<std::string, PluginData*>::iterator iter = data.begin();
+	for (; iter != data.end(); ++iter) delete iter->second;
+}
+
+PluginData* QueryAllocationTest::Context::getPluginData(const std::string& key) const
+{
+	std::map<std::string, PluginData*>::const_iterator iter = data.find(key);
+	return ( iter != data.end() ) ? iter->second : NULL;
+}
+
+void QueryAllocationTest::Context::setPluginData(const std::string& key, PluginData* d)
+{
+	data[key] = d;
+}
+
+void QueryAllocationTest::setUp()
+{
+	const char* filename = "QueryAllocationTest.obj";
+	writeSphere(filename, 16, 8);
+
+	context_ = new Context();
+	LinCannyScene* scene = LinCannyScene::get(context_);
+	for (int n = 0; n < 2 * NumBodies; ++n)
+	{
+		BoundingMesh* mesh = new BoundingMesh(filename);
+		CPPUNIT_ASSERT( mesh->load() );
+
+		LinCannyScene::BodyRef ref;
+		ref.critical = ( n < NumBodies );
+		ref.id = ref.critical ? scene->bodies.addCriticalBody(mesh) : scene->bodies.addBody(mesh);
+
+		char name[16];
+		std::sprintf(name, ref.critical ? "c%d" : "b%d", ref.id);
+		scene->names[name] = ref;
+	}
+	std::remove(filename);
+
+	services_.invokeService = ignoreService;
+	obrsp::plugin::PF_ObjectParams params;
+	params.platformServices = &services_;
+
+	query_ = static_cast<Query*>( DistanceQuery::create(&params) );
+	query_->setContext(context_);
+	moveBodies(0);
+	query_->init();
+}
+
+void QueryAllocationTest::tearDown()
+{
+	DistanceQuery::destroy(query_);
+	delete context_;
+}
+
+void QueryAllocationTest::moveBodies(int frame)
+{
+	BodyManager* bm = LinCannyScene::getBodyManager(context_);
+	double t = 0.1 * frame;
+	for (int n = 0; n < NumBodies; ++n)
+	{
+		bm->setCriticalTransform(n, 3.0 * n + std::sin(t + n), 0.0, 0.0, t, 0.5 * t, 0.0);
+		bm->setTransform(n, 3.0 * n, 2.5 + std::cos(t - n), 0.0, 0.0, t, 0.3 * n);
+	}
+}
+
+// Allocations made by the queries of frames first to last - 1
+unsigned long QueryAllocationTest::runQueries(QueryArguments& args, int first, int last)
+{
+	unsigned long before = g_allocations;
+	for (int frame = first; frame < last; ++frame)
+	{
+		moveBodies(frame);
+		args.resetResults();
+		query_->execute(&args);
+	}
+	return g_allocations - before;
+}
+
+void QueryAllocationTest::testDistanceQuerySteadyState()
+{
+	QueryArguments args;
+	args.parameters.push_back( Property("search_depth", 50) );
+
+	// The first runs size the result vectors, the statistics and the body manager
+	runQueries(args, 0, 3);
+
+	CPPUNIT_ASSERT_EQUAL( 0UL, runQueries(args, 3, 50) );
+	CPPUNIT_ASSERT_EQUAL( (size_t)(NumBodies * NumBodies), args.distanceMap.size() );
+	CPPUNIT_ASSERT_EQUAL( (size_t)(NumBodies * NumBodies), args.critpnt.size() );
+	CPPUNIT_ASSERT_EQUAL( (size_t)4, args.statistics.size() );
+}
+
+void QueryAllocationTest::testTrajectorySteadyState()
+{
+	const int numSteps = 5;
+	std::vector<double> poses(16 * numSteps, 0.0);
+	for (int s = 0; s < numSteps; ++s)
+	{
+		double* T = &poses[16 * s];
+		T[0] = T[5] = T[10] = T[15] = 1.0;
+		T[12] = 0.5 * s;
+		T[13] = 2.5;
+	}
+
+	Property trajectory("trajectory");
+	trajectory.add_parameter( Property("b1", poses) );
+
+	QueryArguments args;
+	args.parameters.push_back( trajectory );
+
+	runQueries(args, 0, 3);
+
+	CPPUNIT_ASSERT_EQUAL( 0UL, runQueries(args, 3, 50) );
+	CPPUNIT_ASSERT_EQUAL( (size_t)(numSteps * NumBodies * NumBodies), args.distanceMap.size() );
+}
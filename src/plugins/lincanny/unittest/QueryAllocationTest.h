@@ -0,0 +1,62 @@
+/*
+ * QueryAllocationTest.h
+ *
+ *  Created on: Apr 22, 2009
+ *      Author: yamokosk
+ */
+
+#ifndef QUERYALLOCATIONTEST_H_
+#define QUERYALLOCATIONTEST_H_
+
+// Logging
+#include <log4cxx/logger.h>
+// CppUnit
+#include <cppunit/extensions/HelperMacros.h>
+// Class to test
+#include <plugins/lincanny/DistanceQuery.h>
+
+#include <map>
+
+/*
+ * Runs distance queries with reused QueryArguments and checks that once the
+ * first few runs have sized everything, later runs allocate no memory.
+ */
+class QueryAllocationTest : public CppUnit::TestFixture
+{
+	static log4cxx::LoggerPtr logger;
+
+	CPPUNIT_TEST_SUITE( QueryAllocationTest );
+	CPPUNIT_TEST( testDistanceQuerySteadyState );
+	CPPUNIT_TEST( testTrajectorySteadyState );
+	CPPUNIT_TEST_SUITE_END();
+
+protected:
+	// Plugin data of a scene that holds nothing else
+	struct Context : public tinysg::SceneContext
+	{
+		~Context();
+		tinysg::PluginData* getPluginData(const std::string& key) const;
+		void setPluginData(const std::string& key, tinysg::PluginData* data);
+
+		std::map<std::string, tinysg::PluginData*> data;
+	};
+
+	static const int NumBodies;
+
+	Context* context_;
+	tinysg::Query* query_;
+	obrsp::plugin::PF_PlatformServices services_;
+
+public:
+	void setUp();
+	void tearDown();
+
+protected:
+	void moveBodies(int frame);
+	unsigned long runQueries(tinysg::QueryArguments& args, int first, int last);
+
+	void testDistanceQuerySteadyState();
+	void testTrajectorySteadyState();
+};
+
+#endif /* QUERYALLOCATIONTEST_H_ */
@@ -66,30 +66,6 @@ void Box::getInfo( ObjectInfo& info ) const
 	Geometry::getInfo(info);
 }
 
-void Box::notifyMoved( const float* translation, const float* rotation )
-{
-#ifdef BUG_dGeomSetPosition
-	std::cout << "In Box::notifyMoved()" << std::endl;
-	std::cout << "p:";
-	for(unsigned int n=0; n < 3; ++n) std::cout << " " << translation[n];
-#endif
-	dGeomSetPosition(odeobj, (dReal)translation[0], (dReal)translation[1], (dReal)translation[2]);
-
-#ifdef BUG_dGeomSetPosition
-	std::cout << ", q:";
-	for(unsigned int n=0; n < 4; ++n) std::cout << " " << rotation[n];
-	std::cout << std::endl;
-#endif
-
-	dQuaternion q = {0};
-	for(unsigned int n=0; n < 4; ++n) q[n] = (dReal)rotation[n];
-	dGeomSetQuaternion(odeobj, q);
-
-#ifdef BUG_dGeomSetPosition
-	std::cout << "Leaving Box::notifyMoved()" << std::endl;
-#endif
-}
-
 void Box::initImpl(const ObjectInfo& info)
 {
 	// Set object name
@@ -65,18 +65,6 @@ void CappedCylinder::getInfo( ObjectInfo& info ) const
 	Geometry::getInfo(info);
 }
 
-void CappedCylinder::notifyMoved( const float* translation, const float* rotation )
-{
-#ifdef BUG_dGeomSetPosition
-	std::cout << "In CappedCylinder::notifyMoved()" << std::endl;
-#endif
-	dGeomSetPosition(odeobj, (dReal)translation[0], (dReal)translation[1], (dReal)translation[2]);
-
-	dQuaternion q = {0};
-	for(unsigned int n=0; n < 4; ++n) q[n] = (dReal)rotation[n];
-	dGeomSetQuaternion(odeobj, q);
-}
-
 void CappedCylinder::initImpl(const ObjectInfo& info)
 {
 	// Set object name
@@ -24,10 +24,15 @@
 
 #include "CollisionQuery.h"
 #include <plugin_framework/Plugin.h>
+#include <api/Services.h>
 #include <boost/any.hpp>
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 
+#include <algorithm>
+
 #include "Space.h"
+#include "PoseSync.h"
 
 const std::string CollisionQuery::Type("ODECollisionQuery");
 
@@ -47,13 +52,24 @@ int CollisionQuery::destroy(void *p)
 	return 0;
 }
 
-CollisionQuery::CollisionQuery()
+CollisionQuery::CollisionQuery() :
+	poseSync(NULL),
+	numThreads(1),
+	mode(AllContacts),
+	found(0),
+	foundAtStart(0)
 {
 
 }
 
 CollisionQuery::~CollisionQuery()
 {
+	pool.reset();
+}
+
+void CollisionQuery::setContext(SceneContext* context)
+{
+	poseSync = PoseSync::get(context);
 }
 
 void CollisionQuery::getInfo(QueryInfo* i)
@@ -63,34 +79,278 @@ void CollisionQuery::getInfo(QueryInfo* i)
 
 void CollisionQuery::execute(QueryArguments* args)
 {
-	BOOST_FOREACH(Property param, args->parameters)
+	// Parameters:
+	//  - every SceneObjectPair parameter names two ODE spaces to collide, or
+	//    one space twice to collide its geoms with each other
+	//  - "threads" (int) collides independent pairs on that many threads
+	//  - "mode" (string) sets how much work is done per pair of geoms:
+	//    "contacts" (default) has ODE work out NUM_CONTACT_POINTS proper
+	//    contacts for every colliding pair. "pairs" records every colliding
+	//    pair, letting ODE stop at any one contact. "first" stops the
+	//    whole query at the first colliding pair, for a yes/no answer. With
+	//    several threads which pair that is can change from run to run.
+	//
+	// Results: objectsInCollision, and in "contacts" mode the contacts ODE
+	// found for each pair. The other modes leave the contact arrays empty;
+	// contactOffsets still gets one (unchanged) offset per pair.
+	pairs.clear();
+	mode = AllContacts;
+	foundAtStart = found;
+	BOOST_FOREACH(const Property& param, args->parameters)
+	{
+		try
+		{
+			if ( param.name_str() == "threads" )
+			{
+				setNumThreads( boost::any_cast<int>(param.const_value()) );
+				continue;
+			}
+
+			if ( param.name_str() == "mode" )
+			{
+				setMode( boost::any_cast<std::string>(param.const_value()) );
+				continue;
+			}
+
+			SceneObjectPair p = boost::any_cast< SceneObjectPair >(param.const_value());
+			pairs.push_back( std::make_pair(static_cast<Space*>(p.first), static_cast<Space*>(p.second)) );
+		}
+		catch (boost::bad_any_cast &)
+		{
+			LOG_WARNING(services, std::string("Collision query parameter '") + param.name() + "' has the wrong type. Ignoring it.");
+		}
+	}
+
+	// Objects attached since the last update have not been handed to ODE yet
+	if ( poseSync != NULL ) poseSync->flush();
+
+	if ( args->contactOffsets.empty() ) args->contactOffsets.push_back(0);
+
+	unsigned int expected = 0;
+	for (unsigned int n = 0; n < pairs.size(); ++n)
+	{
+		expected += expectedCollisions(pairs[n].first, pairs[n].second);
+	}
+	reserveResults(args, expected);
+
+	if ( numThreads < 2 || pairs.size() < 2 )
+	{
+		// Queries may run on any thread, e.g. from a batch query
+		if ( !dAllocateODEDataForThread(dAllocateMaskAll) )
+		{
+			LOG_ERROR(services, "ODE could not set up its data for this thread.");
+			return;
+		}
+
+		for (unsigned int n = 0; n < pairs.size() && !stopped(); ++n)
+		{
+			collidePair(pairs[n].first, pairs[n].second, args);
+		}
+		return;
+	}
+
+	// Each pair collects its own results, merged in parameter order below so
+	// that the results do not depend on how the threads were scheduled
+	if ( pairResults.size() < pairs.size() ) pairResults.resize( pairs.size() );
+	groupPairs();
+	for (unsigned int g = 0; g < groups.size(); ++g)
+	{
+		boost::threadpool::schedule(*pool, boost::bind(&CollisionQuery::collideGroup, this, &groups[g]));
+	}
+	pool->wait();
+
+	for (unsigned int n = 0; n < pairs.size(); ++n)
+	{
+		appendResults(args, pairResults[n]);
+
+		// Threads that found a collision at the same time each kept theirs
+		if ( mode == FirstContact && !args->objectsInCollision.empty() ) break;
+	}
+}
+
+unsigned int CollisionQuery::expectedCollisions(Space* s1, Space* s2)
+{
+	// One collision per geom. Scenes in heavy contact can have more, for
+	// which the vectors still grow, but most queries fit without it.
+	return (s1 == s2) ? s1->getNumGeoms() : s1->getNumGeoms() + s2->getNumGeoms();
+}
+
+void CollisionQuery::reserveResults(QueryArguments* results, unsigned int numCollisions)
+{
+	unsigned int numContacts = (mode == AllContacts) ? numCollisions * NUM_CONTACT_POINTS : 0;
+
+	results->objectsInCollision.reserve( results->objectsInCollision.size() + numCollisions );
+	results->contactOffsets.reserve( results->contactOffsets.size() + numCollisions );
+	results->contactPositions.reserve( results->contactPositions.size() + 3 * numContacts );
+	results->contactNormals.reserve( results->contactNormals.size() + 3 * numContacts );
+	results->contactDepths.reserve( results->contactDepths.size() + numContacts );
+}
+
+void CollisionQuery::appendResults(QueryArguments* args, const QueryArguments& part)
+{
+	args->objectsInCollision.insert(args->objectsInCollision.end(), part.objectsInCollision.begin(), part.objectsInCollision.end());
+
+	unsigned int base = args->contactOffsets.back();
+	for (unsigned int k = 1; k < part.contactOffsets.size(); ++k)
+	{
+		args->contactOffsets.push_back( base + part.contactOffsets[k] );
+	}
+	args->contactPositions.insert(args->contactPositions.end(), part.contactPositions.begin(), part.contactPositions.end());
+	args->contactNormals.insert(args->contactNormals.end(), part.contactNormals.begin(), part.contactNormals.end());
+	args->contactDepths.insert(args->contactDepths.end(), part.contactDepths.begin(), part.contactDepths.end());
+}
+
+void CollisionQuery::setMode(const std::string& name)
+{
+	if ( name == "contacts" )
+		mode = AllContacts;
+	else if ( name == "pairs" )
+		mode = PairsOnly;
+	else if ( name == "first" )
+		mode = FirstContact;
+	else
+		LOG_WARNING(services, "Unknown collision query mode '" + name + "'. Reporting all contacts.");
+}
+
+void CollisionQuery::setNumThreads(int n)
+{
+	if ( n < 1 ) n = 1;
+	if ( n == numThreads ) return;
+
+	// A single thread runs the pairs inline, so only keep a pool around when
+	// there is something to share the work with.
+	if ( n == 1 )
+		pool.reset();
+	else if ( pool.get() )
+		pool->size_controller().resize(n);
+	else
+		pool.reset( new boost::threadpool::pool(n) );
+	numThreads = n;
+}
+
+// Root of pair n in the union-find forest of groupPairs()
+static unsigned int findRoot(std::vector<unsigned int>& parent, unsigned int n)
+{
+	while ( parent[n] != n )
 	{
-		SceneObjectPair p = boost::any_cast< SceneObjectPair >(param.value());
-		Space* s1 = static_cast<Space*>(p.first);
-		Space* s2 = static_cast<Space*>(p.second);
+		parent[n] = parent[parent[n]];
+		n = parent[n];
+	}
+	return n;
+}
 
-		dSpaceCollide2( (dGeomID)s1->getID(), (dGeomID)s2->getID(), (void*)args, CollisionQuery::collisionCallback);
+void CollisionQuery::groupPairs()
+{
+	// ODE updates the bounding boxes and bookkeeping of a space while
+	// colliding it, so two pairs sharing a space must not run at the same
+	// time. Pairs linked through shared spaces form one group, run serially.
+	spaceOwners.clear();
+	for (unsigned int n = 0; n < pairs.size(); ++n)
+	{
+		spaceOwners.push_back( std::make_pair(pairs[n].first, n) );
+		spaceOwners.push_back( std::make_pair(pairs[n].second, n) );
+	}
+	std::sort(spaceOwners.begin(), spaceOwners.end());
+
+	parent.resize( pairs.size() );
+	for (unsigned int n = 0; n < pairs.size(); ++n) parent[n] = n;
+	for (unsigned int k = 1; k < spaceOwners.size(); ++k)
+	{
+		if ( spaceOwners[k].first != spaceOwners[k-1].first ) continue;
+		unsigned int a = findRoot(parent, spaceOwners[k-1].second);
+		unsigned int b = findRoot(parent, spaceOwners[k].second);
+		if ( a != b ) parent[(a > b) ? a : b] = (a > b) ? b : a;
+	}
+
+	// Groups keep their pairs in parameter order
+	for (unsigned int g = 0; g < groups.size(); ++g) groups[g].clear();
+	unsigned int numGroups = 0;
+	groupOf.resize( pairs.size() );
+	for (unsigned int n = 0; n < pairs.size(); ++n)
+	{
+		unsigned int root = findRoot(parent, n);
+		if ( root == n ) groupOf[n] = numGroups++;
+		if ( groups.size() < numGroups ) groups.resize(numGroups);
+		groups[ groupOf[root] ].push_back(n);
+	}
+	groups.resize(numGroups);
+}
+
+void CollisionQuery::collideGroup(const std::vector<unsigned int>* group)
+{
+	// Trimesh colliders keep caches in thread local storage, which ODE
+	// needs to set up once in each thread that collides
+	if ( !dAllocateODEDataForThread(dAllocateMaskAll) )
+	{
+		LOG_ERROR(services, "ODE could not set up its data for a collision thread.");
+		return;
+	}
+
+	for (unsigned int k = 0; k < group->size(); ++k)
+	{
+		unsigned int n = (*group)[k];
+		pairResults[n].resetResults();
+		pairResults[n].contactOffsets.push_back(0);
+		reserveResults(&pairResults[n], expectedCollisions(pairs[n].first, pairs[n].second));
+		if ( !stopped() ) collidePair(pairs[n].first, pairs[n].second, &pairResults[n]);
 	}
 }
 
+void CollisionQuery::collidePair(Space* s1, Space* s2, QueryArguments* results)
+{
+	CallbackData data;
+	data.results = results;
+	data.flags = (mode == AllContacts) ? NUM_CONTACT_POINTS : (1 | CONTACTS_UNIMPORTANT);
+	data.keepContacts = (mode == AllContacts);
+	data.found = (mode == FirstContact) ? &found : NULL;
+	data.foundAtStart = foundAtStart;
+
+	// A space paired with itself has its geoms tested against each other,
+	// which is where hash and sweep and prune spaces pay off. Between two
+	// spaces ODE hands each geom of the smaller to the larger one, and
+	// only the quadtree uses its structure for that.
+	if ( s1 == s2 )
+		dSpaceCollide( s1->getID(), (void*)&data, CollisionQuery::collisionCallback);
+	else
+		dSpaceCollide2( (dGeomID)s1->getID(), (dGeomID)s2->getID(), (void*)&data, CollisionQuery::collisionCallback);
+}
+
 void CollisionQuery::collisionCallback(void* ptr, dGeomID o1, dGeomID o2)
 {
 	// TODO: If the Geom is a TriMesh, I might need to be setting the previous
 	// transform with calls to void dGeomTriMeshSetLastTransform( dGeomID g, dMatrix4 last_trans )
 	// and dReal* dGeomTriMeshGetLastTransform( dGeomID g )
 
+	CallbackData* data = static_cast<CallbackData*>(ptr);
+
+	// ODE can not be told to stop colliding a space, so the remaining
+	// candidates are passed over instead
+	if ( data->found != NULL && *data->found != data->foundAtStart ) return;
+
+	// On the stack, so every thread has its own
 	dContactGeom dContactPts[NUM_CONTACT_POINTS];
 
-	int numContactPts = dCollide(o1, o2, NUM_CONTACT_POINTS, dContactPts, sizeof(dContactGeom));
+	int numContactPts = dCollide(o1, o2, data->flags, dContactPts, sizeof(dContactGeom));
 	if (numContactPts > 0) {
-		QueryArguments* args = static_cast<QueryArguments*>(ptr);
+		QueryArguments* results = data->results;
 
 		// Get the associated SceneObject ids from the void pointer stored in the ODE object
 		SceneObject* obj1 = static_cast<SceneObject*>( dGeomGetData(o1) );
 		SceneObject* obj2 = static_cast<SceneObject*>( dGeomGetData(o2) );
 
-		args->objectsInCollision.push_back( SceneObjectPair(obj1, obj2) );
+		results->objectsInCollision.push_back( SceneObjectPair(obj1, obj2) );
+
+		for (int n = 0; n < numContactPts && data->keepContacts; ++n)
+		{
+			const dContactGeom& c = dContactPts[n];
+			for (int i = 0; i < 3; ++i)
+			{
+				results->contactPositions.push_back( (float)c.pos[i] );
+				results->contactNormals.push_back( (float)c.normal[i] );
+			}
+			results->contactDepths.push_back( (float)c.depth );
+		}
+		results->contactOffsets.push_back( (unsigned int)results->contactDepths.size() );
+		if ( data->found != NULL ) ++(*data->found);
 	}
 }
-
-
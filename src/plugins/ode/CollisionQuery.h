@@ -31,12 +31,22 @@
 
 #include <ode/ode.h>
 
+#include <vector>
+
+#include <boost/detail/atomic_count.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include "threadpool.hpp"
+
 //struct PF_ObjectParams;
 //struct PF_PlatformServices;
 #include <plugin_framework/Plugin.h>
 using namespace obrsp::plugin;
 using namespace tinysg;
 
+class Space;
+class PoseSync;
+
 class CollisionQuery : Query
 {
 public:
@@ -47,17 +57,65 @@ public:
 	~CollisionQuery();
 
 	// Inherited from Query
+	virtual void setContext(SceneContext* context);
 	virtual void getInfo(QueryInfo* info);
 	virtual void execute(QueryArguments* arg);
 
 	const PF_PlatformServices* services;
 
-	// For collision checking
+	// For collision checking. ptr is the CallbackData of the pair collided.
 	static void collisionCallback(void* ptr, dGeomID o1, dGeomID o2);
 private:
+	enum Mode {AllContacts, PairsOnly, FirstContact};
+
+	struct CallbackData
+	{
+		// Where the colliding objects and their contacts go
+		QueryArguments* results;
+		// Contact count and flags for dCollide
+		int flags;
+		// Whether the contacts go into the results or just the pair
+		bool keepContacts;
+		// FirstContact mode only: the query's collision counter and its
+		// value when the query started. NULL in the other modes.
+		boost::detail::atomic_count* found;
+		long foundAtStart;
+	};
+
 	CollisionQuery();
 
+	void setNumThreads(int n);
+	void setMode(const std::string& name);
+	// Splits pairs into groups that share no space
+	void groupPairs();
+	void collideGroup(const std::vector<unsigned int>* group);
+	void collidePair(Space* s1, Space* s2, QueryArguments* results);
+	// Collisions a pair of spaces is expected to have, to size the results
+	static unsigned int expectedCollisions(Space* s1, Space* s2);
+	void reserveResults(QueryArguments* results, unsigned int numCollisions);
+	// Adds the results one pair collected in a thread to args
+	static void appendResults(QueryArguments* args, const QueryArguments& part);
+
 	QueryInfo info;
+	PoseSync* poseSync;
+
+	int numThreads;
+	Mode mode;
+	// Collisions found in FirstContact mode, shared by all threads of a
+	// query. It can not be reset, so a query stops once it has moved past
+	// foundAtStart. A thread reading it late merely does some extra work.
+	boost::detail::atomic_count found;
+	long foundAtStart;
+	bool stopped() const {return found != foundAtStart;}
+	boost::scoped_ptr<boost::threadpool::pool> pool;
+
+	// Kept from one execute() to the next so their memory is reused
+	std::vector< std::pair<Space*, Space*> > pairs;
+	std::vector<QueryArguments> pairResults;
+	std::vector< std::vector<unsigned int> > groups;
+	std::vector< std::pair<Space*, unsigned int> > spaceOwners;
+	std::vector<unsigned int> parent;
+	std::vector<unsigned int> groupOf;
 };
 
 #endif /* COLLISIONQUERY_H_ */
@@ -65,18 +65,6 @@ void Cylinder::getInfo( ObjectInfo& info ) const
 	Geometry::getInfo(info);
 }
 
-void Cylinder::notifyMoved( const Real* translation, const Real* rotation )
-{
-#ifdef BUG_dGeomSetPosition
-	std::cout << "In Cylinder::notifyMoved()" << std::endl;
-#endif
-	dGeomSetPosition(odeobj, (dReal)translation[0], (dReal)translation[1], (dReal)translation[2]);
-
-	dQuaternion q = {0};
-	for(unsigned int n=0; n < 4; ++n) q[n] = (dReal)rotation[n];
-	dGeomSetQuaternion(odeobj, q);
-}
-
 void Cylinder::initImpl(const ObjectInfo& info)
 {
 	// Set object name
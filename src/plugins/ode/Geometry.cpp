@@ -27,20 +27,35 @@
 
 #include "Geometry.h"
 #include "Space.h"
+#include "PoseSync.h"
+
+#include <cstring>
 
 Geometry::Geometry() :
 	services(NULL),
 	space(NULL),
-	odeobj(NULL)
+	odeobj(NULL),
+	poseSync(NULL),
+	synced(false),
+	moved(false)
 {
 
 }
 
 Geometry::~Geometry()
 {
+	if (poseSync != NULL) poseSync->remove(this);
 	if (odeobj != NULL) dGeomDestroy (odeobj);
 }
 
+void Geometry::setContext(SceneContext* context)
+{
+	if (poseSync != NULL) poseSync->remove(this);
+
+	poseSync = PoseSync::get(context);
+	if (poseSync != NULL) poseSync->add(this);
+}
+
 void Geometry::init(const ObjectInfo& info)
 {
 	try {
@@ -158,14 +173,31 @@ void Geometry::setPropertyImpl(const Property& p)
 	throw std::string("Property \"" + p.name_str() + "\" is unknown or can't be 'set' by this object.");
 }
 
-/*void Geometry::notifyMoved( const Real* translation, const Real* rotation )
+void Geometry::notifyMoved( const Real* translation, const Real* rotation )
 {
-	dGeomSetPosition(odeobj, (dReal)translation[0], (dReal)translation[1], (dReal)translation[2]);
-
-	dQuaternion q = {0};
-	for(unsigned int n=0; n < 4; ++n) q[n] = (dReal)rotation[n];
-	dGeomSetQuaternion(odeobj, q);
-}*/
+#ifdef BUG_dGeomSetPosition
+	std::cout << "In Geometry::notifyMoved() for " << name << std::endl;
+#endif
+	for(unsigned int n=0; n < 3; ++n) pose[n] = translation[n];
+	for(unsigned int n=0; n < 4; ++n) pose[3+n] = rotation[n];
+
+	// Nodes below a moved node are notified whether or not their own world
+	// pose changed
+	moved = !synced || memcmp(pose, syncedPose, sizeof(pose)) != 0;
+
+	// Outside of a scene there is nobody to hand the pose over later
+	if ( poseSync == NULL && moved && odeobj != NULL )
+	{
+		dReal R[12];
+		PoseSync::toMatrix(&pose[3], R);
+		dGeomSetPosition(odeobj, (dReal)pose[0], (dReal)pose[1], (dReal)pose[2]);
+		dGeomSetRotation(odeobj, R);
+
+		memcpy(syncedPose, pose, sizeof(pose));
+		synced = true;
+		moved = false;
+	}
+}
 
 /*
  * Setter/getter method implementations
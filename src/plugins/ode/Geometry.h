@@ -51,22 +51,28 @@ using namespace obrsp::plugin;
 using namespace tinysg;
 
 class Space;
+class PoseSync;
 
 /*
  * Generic ODE geometry wrapper
  */
 class Geometry : public SceneObject
 {
+	friend class PoseSync;
+
 public:
 	Geometry();
 	virtual ~Geometry();
 
 	// SceneObject methods
+	void setContext(SceneContext* context);
 	void init(const ObjectInfo& info);
 	Property getProperty(const std::string& name) const;
 	void setProperty(const Property& p);
 	virtual void getInfo(ObjectInfo& info) const;
-	virtual void notifyMoved( const Real* translation, const Real* rotation ) = 0;
+	// Only notes the new pose. The PoseSync of the scene passes it to ODE
+	// once the update is done, so it is safe to call from any update thread.
+	virtual void notifyMoved( const Real* translation, const Real* rotation );
 
 	const PF_PlatformServices* services;
 
@@ -103,6 +109,16 @@ protected:
 	Space* space;
 	dGeomID odeobj;
 	std::string name;
+
+private:
+	PoseSync* poseSync;
+	// World pose waiting for PoseSync, position then orientation w, x, y, z
+	float pose[7];
+	// Last pose ODE was given
+	float syncedPose[7];
+	bool synced;
+	// pose differs from syncedPose
+	bool moved;
 };
 
 #endif /* GEOMETRY_H_ */
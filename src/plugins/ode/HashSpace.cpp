@@ -0,0 +1,137 @@
+/*************************************************************************
+ * SceneML, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * HashSpace.cpp
+ *
+ *  Created on: Apr 24, 2009
+ *      Author: yamokosk
+ */
+
+#include "HashSpace.h"
+#include <plugin_framework/Plugin.h>
+#include <api/Services.h>
+#include <boost/foreach.hpp>
+
+const std::string HashSpace::Type("ODEHashSpace");
+
+void* HashSpace::create(PF_ObjectParams* params)
+{
+	HashSpace* ptr = new HashSpace();
+	ptr->services = params->platformServices;
+	return ptr;
+}
+
+int HashSpace::destroy(void *p)
+{
+	if (!p) return -1;
+
+	delete static_cast<HashSpace*>(p);
+
+	return 0;
+}
+
+HashSpace::HashSpace() : Space()
+{
+
+}
+
+HashSpace::~HashSpace()
+{
+
+}
+
+void HashSpace::getInfo(ObjectInfo& info) const
+{
+	info.type = Type;
+	info.addProperty( getProperty("min_level") );
+	info.addProperty( getProperty("max_level") );
+
+	// Have parent class deal with generic ODE properties
+	Space::getInfo(info);
+}
+
+void HashSpace::initImpl(const ObjectInfo& info)
+{
+	// Set object name
+	name = info.name;
+
+	// Create the ODE hash space
+	odeobj = dHashSpaceCreate (NULL);
+	dSpaceSetCleanup (odeobj, 0);
+	// If there are any applicable parameters, set them now
+	BOOST_FOREACH(const Property& p, info.parameters)
+	{
+		setProperty(p);
+	}
+}
+
+Property HashSpace::getPropertyImpl(const std::string& name) const
+{
+	if ( name == "min_level" ) {
+		return Property(name, getMinLevel());
+	}
+
+	if ( name == "max_level" ) {
+		return Property(name, getMaxLevel());
+	}
+
+	// Have parent class deal with generic ODE properties
+	return Space::getPropertyImpl(name);
+}
+
+void HashSpace::setPropertyImpl(const Property& p)
+{
+	if ( p.name_str() == "min_level" ) {
+		setMinLevel( boost::any_cast<int>(p.const_value()) );
+		return;
+	}
+
+	if ( p.name_str() == "max_level" ) {
+		setMaxLevel( boost::any_cast<int>(p.const_value()) );
+		return;
+	}
+
+	// Have parent class deal with generic ODE properties
+	Space::setPropertyImpl(p);
+}
+
+void HashSpace::setMinLevel(int level)
+{
+	int maxlevel = getMaxLevel();
+	dHashSpaceSetLevels(odeobj, level, (level > maxlevel) ? level : maxlevel);
+}
+
+void HashSpace::setMaxLevel(int level)
+{
+	int minlevel = getMinLevel();
+	dHashSpaceSetLevels(odeobj, (level < minlevel) ? level : minlevel, level);
+}
+
+int HashSpace::getMinLevel() const
+{
+	int minlevel = 0, maxlevel = 0;
+	dHashSpaceGetLevels(odeobj, &minlevel, &maxlevel);
+	return minlevel;
+}
+
+int HashSpace::getMaxLevel() const
+{
+	int minlevel = 0, maxlevel = 0;
+	dHashSpaceGetLevels(odeobj, &minlevel, &maxlevel);
+	return maxlevel;
+}
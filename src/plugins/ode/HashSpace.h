@@ -0,0 +1,66 @@
+/*************************************************************************
+ * SceneML, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * HashSpace.h
+ *
+ *  Created on: Apr 24, 2009
+ *      Author: yamokosk
+ */
+
+#ifndef HASHSPACE_H_
+#define HASHSPACE_H_
+
+#include "Space.h"
+
+/*
+ * ODE multi-resolution hash space. Geoms are hashed into cubic cells with
+ * sides 2^min_level up to 2^max_level, so only geoms sharing a cell are
+ * tested against each other.
+ */
+class HashSpace: public Space
+{
+public:
+	// static plugin interface
+	static void* create(PF_ObjectParams *);
+	static int destroy(void *);
+	static const std::string Type;
+	~HashSpace();
+
+	// SceneObject methods
+	virtual void getInfo(ObjectInfo& info) const;
+	virtual void notifyMoved( const float* translation, const float* rotation ) {};
+
+protected:
+	// Space methods
+	virtual void initImpl(const ObjectInfo& info);
+	virtual Property getPropertyImpl(const std::string& name) const;
+	virtual void setPropertyImpl(const Property& p);
+
+private:
+	// Setting one level past the other moves the other along, so the two
+	// can be given in either order
+	void setMinLevel(int level);
+	void setMaxLevel(int level);
+
+	int getMinLevel() const;
+	int getMaxLevel() const;
+
+	HashSpace();
+};
+
+#endif /* HASHSPACE_H_ */
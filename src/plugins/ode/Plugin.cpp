@@ -11,6 +11,9 @@
 #include "Cylinder.h"
 #include "TriangleMesh.h"
 #include "SimpleSpace.h"
+#include "HashSpace.h"
+#include "QuadTreeSpace.h"
+#include "SweepAndPruneSpace.h"
 #include "CollisionQuery.h"
 
 extern "C" int ODE_Plugin_ExitFunc()
@@ -41,6 +44,9 @@ extern "C" PF_ExitFunc ODE_Plugin_InitPlugin(const PF_PlatformServices* params)
 	REGISTER_CPP_CLASS( params, rp, Cylinder, status );
 	REGISTER_CPP_CLASS( params, rp, TriangleMesh, status );
 	REGISTER_CPP_CLASS( params, rp, SimpleSpace, status );
+	REGISTER_CPP_CLASS( params, rp, HashSpace, status );
+	REGISTER_CPP_CLASS( params, rp, QuadTreeSpace, status );
+	REGISTER_CPP_CLASS( params, rp, SweepAndPruneSpace, status );
 	REGISTER_CPP_CLASS( params, rp, CollisionQuery, status );
 
 	if (status < 0) {
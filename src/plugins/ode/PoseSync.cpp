@@ -0,0 +1,106 @@
+/*************************************************************************
+ * SceneML, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * PoseSync.cpp
+ *
+ *  Created on: Apr 24, 2009
+ *      Author: yamokosk
+ */
+
+#include "PoseSync.h"
+#include "Geometry.h"
+
+#include <algorithm>
+#include <cstring>
+
+const std::string PoseSync::Key("ODEPoseSync");
+
+PoseSync* PoseSync::get(SceneContext* context)
+{
+	if ( context == NULL ) return NULL;
+
+	PoseSync* sync = static_cast<PoseSync*>( context->getPluginData(Key) );
+	if ( sync == NULL )
+	{
+		sync = new PoseSync();
+		context->setPluginData(Key, sync);
+	}
+	return sync;
+}
+
+void PoseSync::add(Geometry* geom)
+{
+	geoms.push_back(geom);
+}
+
+void PoseSync::remove(Geometry* geom)
+{
+	geoms.erase( std::remove(geoms.begin(), geoms.end(), geom), geoms.end() );
+}
+
+void PoseSync::flush()
+{
+	moved.clear();
+	for (unsigned int n = 0; n < geoms.size(); ++n)
+	{
+		if ( geoms[n]->moved && geoms[n]->odeobj != NULL ) moved.push_back(geoms[n]);
+	}
+	if ( moved.empty() ) return;
+
+	// All orientations are turned into matrices in one go, instead of ODE
+	// doing it geom by geom inside dGeomSetQuaternion()
+	rotations.resize( 12 * moved.size() );
+	for (unsigned int n = 0; n < moved.size(); ++n)
+	{
+		toMatrix(&moved[n]->pose[3], &rotations[12 * n]);
+	}
+
+	for (unsigned int n = 0; n < moved.size(); ++n)
+	{
+		Geometry* geom = moved[n];
+		dGeomSetPosition(geom->odeobj, (dReal)geom->pose[0], (dReal)geom->pose[1], (dReal)geom->pose[2]);
+		dGeomSetRotation(geom->odeobj, &rotations[12 * n]);
+
+		memcpy(geom->syncedPose, geom->pose, sizeof(geom->pose));
+		geom->synced = true;
+		geom->moved = false;
+	}
+}
+
+void PoseSync::toMatrix(const float* q, dReal* R)
+{
+	// Same arithmetic as ODE's dQtoR()
+	dReal qq1 = 2 * (dReal)q[1] * (dReal)q[1];
+	dReal qq2 = 2 * (dReal)q[2] * (dReal)q[2];
+	dReal qq3 = 2 * (dReal)q[3] * (dReal)q[3];
+
+	R[0] = 1 - qq2 - qq3;
+	R[1] = 2 * ((dReal)q[1] * (dReal)q[2] - (dReal)q[0] * (dReal)q[3]);
+	R[2] = 2 * ((dReal)q[1] * (dReal)q[3] + (dReal)q[0] * (dReal)q[2]);
+	R[3] = 0;
+
+	R[4] = 2 * ((dReal)q[1] * (dReal)q[2] + (dReal)q[0] * (dReal)q[3]);
+	R[5] = 1 - qq1 - qq3;
+	R[6] = 2 * ((dReal)q[2] * (dReal)q[3] - (dReal)q[0] * (dReal)q[1]);
+	R[7] = 0;
+
+	R[8] = 2 * ((dReal)q[1] * (dReal)q[3] - (dReal)q[0] * (dReal)q[2]);
+	R[9] = 2 * ((dReal)q[2] * (dReal)q[3] + (dReal)q[0] * (dReal)q[1]);
+	R[10] = 1 - qq1 - qq2;
+	R[11] = 0;
+}
@@ -0,0 +1,74 @@
+/*************************************************************************
+ * SceneML, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * PoseSync.h
+ *
+ *  Created on: Apr 24, 2009
+ *      Author: yamokosk
+ */
+
+#ifndef POSESYNC_H_
+#define POSESYNC_H_
+
+#include <api/ObjectModel.h>
+
+// ODE library
+#include <ode/ode.h>
+
+#include <string>
+#include <vector>
+
+using namespace tinysg;
+
+class Geometry;
+
+/*
+ * Hands the world poses of the ODE geoms of one scene to ODE after an
+ * update. Geoms only note their new pose in notifyMoved(), which runs on
+ * the update threads, and ODE is called from one thread once all nodes
+ * are done.
+ */
+class PoseSync : public PluginData
+{
+public:
+	static const std::string Key;
+
+	// Returns the PoseSync of the scene owning context, creating it on first use.
+	static PoseSync* get(SceneContext* context);
+
+	void add(Geometry* geom);
+	void remove(Geometry* geom);
+
+	// Passes the poses of all geoms that moved since the last call to ODE
+	void flush();
+
+	// Inherited from PluginData
+	virtual void notifyUpdated() {flush();}
+
+	// Rotation matrix of a unit quaternion (w, x, y, z), laid out like ODE's dMatrix3
+	static void toMatrix(const float* q, dReal* R);
+
+private:
+	std::vector<Geometry*> geoms;
+
+	// Kept from one flush() to the next so their memory is reused
+	std::vector<Geometry*> moved;
+	std::vector<dReal> rotations;
+};
+
+#endif /* POSESYNC_H_ */
@@ -0,0 +1,137 @@
+/*************************************************************************
+ * SceneML, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * QuadTreeSpace.cpp
+ *
+ *  Created on: Apr 24, 2009
+ *      Author: yamokosk
+ */
+
+#include "QuadTreeSpace.h"
+#include <plugin_framework/Plugin.h>
+#include <api/Services.h>
+#include <boost/foreach.hpp>
+
+const std::string QuadTreeSpace::Type("ODEQuadTreeSpace");
+
+void* QuadTreeSpace::create(PF_ObjectParams* params)
+{
+	QuadTreeSpace* ptr = new QuadTreeSpace();
+	ptr->services = params->platformServices;
+	return ptr;
+}
+
+int QuadTreeSpace::destroy(void *p)
+{
+	if (!p) return -1;
+
+	delete static_cast<QuadTreeSpace*>(p);
+
+	return 0;
+}
+
+QuadTreeSpace::QuadTreeSpace() :
+	Space(),
+	center(0.0, 0.0, 0.0),
+	extents(10.0, 10.0, 10.0),
+	depth(4)
+{
+
+}
+
+QuadTreeSpace::~QuadTreeSpace()
+{
+
+}
+
+void QuadTreeSpace::getInfo(ObjectInfo& info) const
+{
+	info.type = Type;
+	info.addProperty( getProperty("center") );
+	info.addProperty( getProperty("extents") );
+	info.addProperty( getProperty("depth") );
+
+	// Have parent class deal with generic ODE properties
+	Space::getInfo(info);
+}
+
+void QuadTreeSpace::initImpl(const ObjectInfo& info)
+{
+	// Set object name
+	name = info.name;
+
+	// Create the ODE quadtree space. Each layout parameter below makes a new
+	// one, which is cheap while it holds no geoms.
+	replaceSpace( createSpace() );
+	// If there are any applicable parameters, set them now
+	BOOST_FOREACH(const Property& p, info.parameters)
+	{
+		setProperty(p);
+	}
+}
+
+Property QuadTreeSpace::getPropertyImpl(const std::string& name) const
+{
+	if ( name == "center" ) {
+		return Property(name, center);
+	}
+
+	if ( name == "extents" ) {
+		return Property(name, extents);
+	}
+
+	if ( name == "depth" ) {
+		return Property(name, depth);
+	}
+
+	// Have parent class deal with generic ODE properties
+	return Space::getPropertyImpl(name);
+}
+
+void QuadTreeSpace::setPropertyImpl(const Property& p)
+{
+	if ( p.name_str() == "center" ) {
+		center = boost::any_cast<Vector3>(p.const_value());
+		replaceSpace( createSpace() );
+		return;
+	}
+
+	if ( p.name_str() == "extents" ) {
+		extents = boost::any_cast<Vector3>(p.const_value());
+		replaceSpace( createSpace() );
+		return;
+	}
+
+	if ( p.name_str() == "depth" ) {
+		int d = boost::any_cast<int>(p.const_value());
+		if ( d < 0 ) throw std::string("Quadtree depth can not be negative.");
+		depth = d;
+		replaceSpace( createSpace() );
+		return;
+	}
+
+	// Have parent class deal with generic ODE properties
+	Space::setPropertyImpl(p);
+}
+
+dSpaceID QuadTreeSpace::createSpace() const
+{
+	dVector3 c = {(dReal)center[0], (dReal)center[1], (dReal)center[2], 0};
+	dVector3 e = {(dReal)extents[0], (dReal)extents[1], (dReal)extents[2], 0};
+	return dQuadTreeSpaceCreate (NULL, c, e, depth);
+}
@@ -58,7 +58,9 @@ SimpleSpace::~SimpleSpace()
 void SimpleSpace::getInfo(ObjectInfo& info) const
 {
 	info.type = Type;
-	info.name = name;
+
+	// Have parent class deal with generic ODE properties
+	Space::getInfo(info);
 }
 
 void SimpleSpace::initImpl(const ObjectInfo& info)
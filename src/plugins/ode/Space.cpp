@@ -26,7 +26,9 @@
 #include <plugin_framework/Plugin.h>
 #include <api/Services.h>
 
-Space::Space()
+Space::Space() :
+	services(NULL),
+	odeobj(NULL)
 {
 
 }
@@ -84,6 +86,30 @@ void Space::setProperty(const Property& p)
 	}
 }
 
+void Space::getInfo(ObjectInfo& info) const
+{
+	info.name = name;
+}
+
+void Space::replaceSpace(dSpaceID newobj)
+{
+	// Geoms outlive the spaces they are in
+	dSpaceSetCleanup(newobj, 0);
+
+	if (odeobj != NULL)
+	{
+		// Removing a geom moves the others down, so always take the first
+		while ( dSpaceGetNumGeoms(odeobj) > 0 )
+		{
+			dGeomID id = dSpaceGetGeom(odeobj, 0);
+			dSpaceRemove(odeobj, id);
+			dSpaceAdd(newobj, id);
+		}
+		dSpaceDestroy(odeobj);
+	}
+	odeobj = newobj;
+}
+
 Property Space::getPropertyImpl( const std::string& name ) const
 {
 	// Unknown/unsupported property
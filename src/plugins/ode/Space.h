@@ -47,11 +47,13 @@ public:
 	void removeGeometry(dGeomID id) {dSpaceRemove(odeobj, id);}
 	void addGeometry(dGeomID id) {dSpaceAdd(odeobj, id);}
 	dSpaceID getID() {return odeobj;}
+	unsigned int getNumGeoms() {return (unsigned int)dSpaceGetNumGeoms(odeobj);}
 
 	// Inherited from SceneObject
 	void init( const ObjectInfo& info );
 	Property getProperty(const std::string& name) const;
 	void setProperty(const Property& p);
+	virtual void getInfo(ObjectInfo& info) const;
 	virtual void notifyMoved( const Real* translation, const Real* rotation ) = 0;
 
 	const PF_PlatformServices* services;
@@ -61,6 +63,10 @@ protected:
 	virtual Property getPropertyImpl( const std::string& name ) const;
 	virtual void setPropertyImpl( const Property& prop );
 
+	// Swaps the ODE space for newobj and moves every geom over to it. For
+	// settings ODE only takes when a space is created.
+	void replaceSpace(dSpaceID newobj);
+
 	dSpaceID odeobj;
 	std::string name;
 };
@@ -64,18 +64,6 @@ void Sphere::getInfo( ObjectInfo& info ) const
 	Geometry::getInfo(info);
 }
 
-void Sphere::notifyMoved( const Real* translation, const Real* rotation )
-{
-#ifdef BUG_dGeomSetPosition
-	std::cout << "In Sphere::notifyMoved()" << std::endl;
-#endif
-	dGeomSetPosition(odeobj, (dReal)translation[0], (dReal)translation[1], (dReal)translation[2]);
-
-	dQuaternion q = {0};
-	for(unsigned int n=0; n < 4; ++n) q[n] = (dReal)rotation[n];
-	dGeomSetQuaternion(odeobj, q);
-}
-
 void Sphere::initImpl(const ObjectInfo& info)
 {
 	// Set object name
@@ -41,7 +41,6 @@ public:
 
 	// SceneObject methods
 	virtual void getInfo(ObjectInfo& info) const;
-	virtual void notifyMoved( const float* translation, const float* rotation );
 
 protected:
 	// Geometry methods
@@ -0,0 +1,117 @@
+/*************************************************************************
+ * SceneML, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * SweepAndPruneSpace.cpp
+ *
+ *  Created on: Apr 24, 2009
+ *      Author: yamokosk
+ */
+
+#include "SweepAndPruneSpace.h"
+#include <plugin_framework/Plugin.h>
+#include <api/Services.h>
+#include <boost/foreach.hpp>
+
+const std::string SweepAndPruneSpace::Type("ODESweepAndPruneSpace");
+
+void* SweepAndPruneSpace::create(PF_ObjectParams* params)
+{
+	SweepAndPruneSpace* ptr = new SweepAndPruneSpace();
+	ptr->services = params->platformServices;
+	return ptr;
+}
+
+int SweepAndPruneSpace::destroy(void *p)
+{
+	if (!p) return -1;
+
+	delete static_cast<SweepAndPruneSpace*>(p);
+
+	return 0;
+}
+
+SweepAndPruneSpace::SweepAndPruneSpace() :
+	Space(),
+	axisOrder("xyz")
+{
+
+}
+
+SweepAndPruneSpace::~SweepAndPruneSpace()
+{
+
+}
+
+void SweepAndPruneSpace::getInfo(ObjectInfo& info) const
+{
+	info.type = Type;
+	info.addProperty( getProperty("axis_order") );
+
+	// Have parent class deal with generic ODE properties
+	Space::getInfo(info);
+}
+
+void SweepAndPruneSpace::initImpl(const ObjectInfo& info)
+{
+	// Set object name
+	name = info.name;
+
+	// Create the ODE sweep and prune space
+	replaceSpace( dSweepAndPruneSpaceCreate (NULL, dSAP_AXES_XYZ) );
+	// If there are any applicable parameters, set them now
+	BOOST_FOREACH(const Property& p, info.parameters)
+	{
+		setProperty(p);
+	}
+}
+
+Property SweepAndPruneSpace::getPropertyImpl(const std::string& name) const
+{
+	if ( name == "axis_order" ) {
+		return Property(name, axisOrder);
+	}
+
+	// Have parent class deal with generic ODE properties
+	return Space::getPropertyImpl(name);
+}
+
+void SweepAndPruneSpace::setPropertyImpl(const Property& p)
+{
+	if ( p.name_str() == "axis_order" ) {
+		setAxisOrder( boost::any_cast<std::string>(p.const_value()) );
+		return;
+	}
+
+	// Have parent class deal with generic ODE properties
+	Space::setPropertyImpl(p);
+}
+
+void SweepAndPruneSpace::setAxisOrder(const std::string& order)
+{
+	int axes = 0;
+	if ( order == "xyz" ) axes = dSAP_AXES_XYZ;
+	else if ( order == "xzy" ) axes = dSAP_AXES_XZY;
+	else if ( order == "yxz" ) axes = dSAP_AXES_YXZ;
+	else if ( order == "yzx" ) axes = dSAP_AXES_YZX;
+	else if ( order == "zxy" ) axes = dSAP_AXES_ZXY;
+	else if ( order == "zyx" ) axes = dSAP_AXES_ZYX;
+	else throw std::string("Unknown axis order \"" + order + "\", expected a permutation of \"xyz\".");
+
+	axisOrder = order;
+	replaceSpace( dSweepAndPruneSpaceCreate (NULL, axes) );
+}
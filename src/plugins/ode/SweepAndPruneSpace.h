@@ -0,0 +1,64 @@
+/*************************************************************************
+ * SceneML, Copyright (C) 2007, 2008  J.D. Yamokoski
+ * All rights reserved.
+ * Email: yamokosk at gmail dot com
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the License,
+ * or (at your option) any later version. The text of the GNU Lesser General
+ * Public License is included with this library in the file LICENSE.TXT.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the file LICENSE.TXT for
+ * more details.
+ *
+ *************************************************************************/
+/*
+ * SweepAndPruneSpace.h
+ *
+ *  Created on: Apr 24, 2009
+ *      Author: yamokosk
+ */
+
+#ifndef SWEEPANDPRUNESPACE_H_
+#define SWEEPANDPRUNESPACE_H_
+
+#include "Space.h"
+
+/*
+ * ODE sweep and prune space. Sorts the geoms' bounding boxes along the axes
+ * in axis_order ("xyz", "zyx", ...), the first one doing most of the culling,
+ * so it should be the axis the geoms are most spread along.
+ */
+class SweepAndPruneSpace: public Space
+{
+public:
+	// static plugin interface
+	static void* create(PF_ObjectParams *);
+	static int destroy(void *);
+	static const std::string Type;
+	~SweepAndPruneSpace();
+
+	// SceneObject methods
+	virtual void getInfo(ObjectInfo& info) const;
+	virtual void notifyMoved( const float* translation, const float* rotation ) {};
+
+protected:
+	// Space methods
+	virtual void initImpl(const ObjectInfo& info);
+	virtual Property getPropertyImpl(const std::string& name) const;
+	virtual void setPropertyImpl(const Property& p);
+
+private:
+	// ODE only takes the axis order when the space is created, so changing
+	// it makes a new space
+	void setAxisOrder(const std::string& order);
+
+	std::string axisOrder;
+
+	SweepAndPruneSpace();
+};
+
+#endif /* SWEEPANDPRUNESPACE_H_ */
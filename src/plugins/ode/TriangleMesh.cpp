@@ -71,21 +71,6 @@ void TriangleMesh::getInfo( ObjectInfo& info ) const
 #endif
 }
 
-void TriangleMesh::notifyMoved( const float* translation, const float* rotation )
-{
-#ifdef BUG_dGeomSetPosition
-	std::cout << "In TriangleMesh::notifyMoved()" << std::endl;
-#endif
-	if ( mesh_ != NULL )
-	{
-		dGeomSetPosition(odeobj, (dReal)translation[0], (dReal)translation[1], (dReal)translation[2]);
-
-		dQuaternion q = {0};
-		for(unsigned int n=0; n < 4; ++n) q[n] = (dReal)rotation[n];
-		dGeomSetQuaternion(odeobj, q);
-	}
-}
-
 void TriangleMesh::initImpl(const ObjectInfo& info)
 {
 #ifdef BUG_dGeomSetPosition
@@ -0,0 +1,156 @@
+/*
+ * BinaryArchiveTest.cpp
+ *
+ *  Created on: Apr 2, 2009
+ *      Author: yamokosk
+ */
+
+#include <cppunit/config/SourcePrefix.h>
+#include "BinaryArchiveTest.h"
+
+#include <NodeUtils.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+using namespace log4cxx;
+using namespace tinysg;
+
+LoggerPtr BinaryArchiveTest::logger(Logger::getLogger("BinaryArchiveTest"));
+
+CPPUNIT_TEST_SUITE_REGISTRATION( BinaryArchiveTest );
+
+const char* BinaryArchiveTest::BinaryFile = "BinaryArchiveTest.bin";
+const char* BinaryArchiveTest::XmlFile = "BinaryArchiveTest.xml";
+const char* BinaryArchiveTest::TruncatedFile = "BinaryArchiveTest_truncated.bin";
+
+std::vector<std::string> BinaryArchiveTest::buildScene(SceneGraph& graph)
+{
+	std::srand(1);
+
+	std::vector<SceneNode*> nodes(1, graph.getNode(SceneGraph::World));
+	std::vector<std::string> names;
+	for (unsigned int n = 0; n < 200; ++n)
+	{
+		std::stringstream ss;
+		ss << "link" << n;
+
+		SceneNode* child = nodes[ std::rand() % nodes.size() ]->createChild(ss.str());
+		translate(child, Vector3((Real)(std::rand() % 100) / 10, -1.5, (Real)n / 7));
+		rotate(child, Vector3(0.0, 1.0, 1.0).normalisedCopy(), (Real)(std::rand() % 100) / 50);
+
+		nodes.push_back(child);
+		names.push_back(ss.str());
+	}
+	graph.update();
+	return names;
+}
+
+void BinaryArchiveTest::assertSameNodes(const SceneGraph& a, const SceneGraph& b,
+										const std::vector<std::string>& names, double tolerance)
+{
+	for (unsigned int n = 0; n < names.size(); ++n)
+	{
+		SceneNode* na = a.getNode(names[n]);
+		SceneNode* nb = b.getNode(names[n]);
+		CPPUNIT_ASSERT( nb != NULL );
+		CPPUNIT_ASSERT_EQUAL( na->getParent()->getName(), nb->getParent()->getName() );
+
+		const Vector3& pa = na->getPosition();
+		const Vector3& pb = nb->getPosition();
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( pa.x, pb.x, tolerance );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( pa.y, pb.y, tolerance );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( pa.z, pb.z, tolerance );
+
+		const Quaternion& qa = na->getOrientation();
+		const Quaternion& qb = nb->getOrientation();
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( qa.w, qb.w, tolerance );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( qa.x, qb.x, tolerance );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( qa.y, qb.y, tolerance );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( qa.z, qb.z, tolerance );
+	}
+}
+
+void BinaryArchiveTest::setUp()
+{
+
+}
+
+void BinaryArchiveTest::tearDown()
+{
+	std::remove(BinaryFile);
+	std::remove(XmlFile);
+	std::remove(TruncatedFile);
+}
+
+void BinaryArchiveTest::testRoundTrip()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	SceneGraph saved(1);
+	std::vector<std::string> names = buildScene(saved);
+	SceneLoader::save(BinaryFile, saved, SF_BINARY);
+
+	SceneGraph loaded(1);
+	SceneLoader::load(BinaryFile, loaded);
+
+	// Poses are stored as the floats they are kept in
+	assertSameNodes(saved, loaded, names, 0.0);
+	CPPUNIT_ASSERT_EQUAL( saved.getNumObjects(), loaded.getNumObjects() );
+}
+
+void BinaryArchiveTest::testFormatDetection()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	SceneGraph graph(1);
+	buildScene(graph);
+	SceneLoader::save(BinaryFile, graph, SF_BINARY);
+	SceneLoader::save(XmlFile, graph, SF_XML);
+
+	CPPUNIT_ASSERT( BinaryArchive::isBinaryFile(BinaryFile) );
+	CPPUNIT_ASSERT( !BinaryArchive::isBinaryFile(XmlFile) );
+	CPPUNIT_ASSERT_EQUAL( SF_BINARY, SceneLoader::getFormat(BinaryFile) );
+	CPPUNIT_ASSERT_EQUAL( SF_XML, SceneLoader::getFormat(XmlFile) );
+}
+
+void BinaryArchiveTest::testConvertFromXml()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	SceneGraph graph(1);
+	std::vector<std::string> names = buildScene(graph);
+	SceneLoader::save(XmlFile, graph, SF_XML);
+	SceneLoader::convert(XmlFile, BinaryFile, SF_BINARY);
+
+	SceneGraph fromXml(1), fromBinary(1);
+	SceneLoader::load(XmlFile, fromXml);
+	SceneLoader::load(BinaryFile, fromBinary);
+
+	assertSameNodes(fromXml, fromBinary, names, 0.0);
+	// XML only keeps six digits
+	assertSameNodes(graph, fromBinary, names, 1e-4);
+}
+
+void BinaryArchiveTest::testTruncatedFile()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	SceneGraph graph(1);
+	buildScene(graph);
+	SceneLoader::save(BinaryFile, graph, SF_BINARY);
+
+	std::ifstream in(BinaryFile, std::ios::in | std::ios::binary);
+	std::string contents( (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>() );
+	in.close();
+
+	std::ofstream out(TruncatedFile, std::ios::out | std::ios::binary);
+	out.write(contents.data(), contents.size() / 2);
+	out.close();
+
+	SceneGraph loaded(1);
+	CPPUNIT_ASSERT_THROW( SceneLoader::load(TruncatedFile, loaded), std::string );
+}
@@ -0,0 +1,54 @@
+/*
+ * BinaryArchiveTest.h
+ *
+ *  Created on: Apr 2, 2009
+ *      Author: yamokosk
+ */
+
+#ifndef BINARYARCHIVETEST_H_
+#define BINARYARCHIVETEST_H_
+
+// Logging
+#include <log4cxx/logger.h>
+// CppUnit
+#include <cppunit/extensions/HelperMacros.h>
+// Class to test
+#include <BinaryArchive.h>
+#include <SceneGraph.h>
+
+#include <string>
+#include <vector>
+
+class BinaryArchiveTest : public CppUnit::TestFixture
+{
+	static log4cxx::LoggerPtr logger;
+
+	CPPUNIT_TEST_SUITE( BinaryArchiveTest );
+	CPPUNIT_TEST( testRoundTrip );
+	CPPUNIT_TEST( testFormatDetection );
+	CPPUNIT_TEST( testConvertFromXml );
+	CPPUNIT_TEST( testTruncatedFile );
+	CPPUNIT_TEST_SUITE_END();
+
+protected:
+	static const char* BinaryFile;
+	static const char* XmlFile;
+	static const char* TruncatedFile;
+
+	// Returns the names of the nodes below the world node
+	static std::vector<std::string> buildScene(tinysg::SceneGraph& graph);
+	static void assertSameNodes(const tinysg::SceneGraph& a, const tinysg::SceneGraph& b,
+								const std::vector<std::string>& names, double tolerance);
+
+public:
+	void setUp();
+	void tearDown();
+
+protected:
+	void testRoundTrip();
+	void testFormatDetection();
+	void testConvertFromXml();
+	void testTruncatedFile();
+};
+
+#endif /* BINARYARCHIVETEST_H_ */
@@ -0,0 +1,106 @@
+/*
+ * NameTableTest.cpp
+ *
+ *  Created on: Mar 23, 2009
+ *      Author: yamokosk
+ */
+
+#include <cppunit/config/SourcePrefix.h>
+#include "NameTableTest.h"
+
+#include <sstream>
+
+using namespace log4cxx;
+using namespace tinysg;
+
+LoggerPtr NameTableTest::logger(Logger::getLogger("NameTableTest"));
+
+CPPUNIT_TEST_SUITE_REGISTRATION( NameTableTest );
+
+void NameTableTest::setUp()
+{
+	table_ = new NameTable();
+}
+
+void NameTableTest::tearDown()
+{
+	delete table_;
+}
+
+void NameTableTest::testInternTwice()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	NameHandle first = table_->intern("link1");
+	NameHandle second = table_->intern("link1");
+
+	CPPUNIT_ASSERT_EQUAL( first, second );
+	CPPUNIT_ASSERT_EQUAL( 1u, table_->size() );
+}
+
+void NameTableTest::testHandlesAreDense()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	CPPUNIT_ASSERT_EQUAL( (NameHandle)0, table_->intern("a") );
+	CPPUNIT_ASSERT_EQUAL( (NameHandle)1, table_->intern("b") );
+	CPPUNIT_ASSERT_EQUAL( (NameHandle)2, table_->intern("c") );
+
+	CPPUNIT_ASSERT_EQUAL( std::string("a"), table_->getName(0) );
+	CPPUNIT_ASSERT_EQUAL( std::string("b"), table_->getName(1) );
+	CPPUNIT_ASSERT_EQUAL( std::string("c"), table_->getName(2) );
+}
+
+void NameTableTest::testFindUnknownName()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	CPPUNIT_ASSERT_EQUAL( NameTable::InvalidHandle, table_->find("missing") );
+
+	table_->intern("present");
+	CPPUNIT_ASSERT_EQUAL( NameTable::InvalidHandle, table_->find("missing") );
+	CPPUNIT_ASSERT_EQUAL( (NameHandle)0, table_->find("present") );
+
+	// Looking a name up must not add it
+	CPPUNIT_ASSERT_EQUAL( 1u, table_->size() );
+}
+
+void NameTableTest::testSimilarNames()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	NameHandle empty = table_->intern("");
+	NameHandle ab = table_->intern("ab");
+	NameHandle ba = table_->intern("ba");
+	NameHandle abc = table_->intern("abc");
+
+	CPPUNIT_ASSERT( empty != ab );
+	CPPUNIT_ASSERT( ab != ba );
+	CPPUNIT_ASSERT( ab != abc );
+	CPPUNIT_ASSERT_EQUAL( empty, table_->find("") );
+	CPPUNIT_ASSERT_EQUAL( ba, table_->find("ba") );
+	CPPUNIT_ASSERT_EQUAL( 4u, table_->size() );
+}
+
+void NameTableTest::testGrowKeepsHandles()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	// Enough names to double the bucket array several times
+	const unsigned int NumNames = 10000;
+	for (unsigned int n = 0; n < NumNames; ++n)
+	{
+		std::stringstream ss;
+		ss << "node" << n;
+		CPPUNIT_ASSERT_EQUAL( (NameHandle)n, table_->intern(ss.str()) );
+	}
+	CPPUNIT_ASSERT_EQUAL( NumNames, table_->size() );
+
+	for (unsigned int n = 0; n < NumNames; ++n)
+	{
+		std::stringstream ss;
+		ss << "node" << n;
+		CPPUNIT_ASSERT_EQUAL( (NameHandle)n, table_->find(ss.str()) );
+		CPPUNIT_ASSERT_EQUAL( ss.str(), table_->getName(n) );
+	}
+}
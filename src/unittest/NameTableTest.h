@@ -0,0 +1,45 @@
+/*
+ * NameTableTest.h
+ *
+ *  Created on: Mar 23, 2009
+ *      Author: yamokosk
+ */
+
+#ifndef NAMETABLETEST_H_
+#define NAMETABLETEST_H_
+
+// Logging
+#include <log4cxx/logger.h>
+// CppUnit
+#include <cppunit/extensions/HelperMacros.h>
+// Class to test
+#include <NameTable.h>
+
+class NameTableTest : public CppUnit::TestFixture
+{
+	static log4cxx::LoggerPtr logger;
+
+	CPPUNIT_TEST_SUITE( NameTableTest );
+	CPPUNIT_TEST( testInternTwice );
+	CPPUNIT_TEST( testHandlesAreDense );
+	CPPUNIT_TEST( testFindUnknownName );
+	CPPUNIT_TEST( testSimilarNames );
+	CPPUNIT_TEST( testGrowKeepsHandles );
+	CPPUNIT_TEST_SUITE_END();
+
+protected:
+	tinysg::NameTable* table_;
+
+public:
+	void setUp();
+	void tearDown();
+
+protected:
+	void testInternTwice();
+	void testHandlesAreDense();
+	void testFindUnknownName();
+	void testSimilarNames();
+	void testGrowKeepsHandles();
+};
+
+#endif /* NAMETABLETEST_H_ */
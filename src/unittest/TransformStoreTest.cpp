@@ -0,0 +1,100 @@
+/*
+ * TransformStoreTest.cpp
+ *
+ *  Created on: Mar 30, 2009
+ *      Author: yamokosk
+ */
+
+#include <cppunit/config/SourcePrefix.h>
+#include "TransformStoreTest.h"
+
+using namespace log4cxx;
+using namespace tinysg;
+
+LoggerPtr TransformStoreTest::logger(Logger::getLogger("TransformStoreTest"));
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TransformStoreTest );
+
+void TransformStoreTest::setUp()
+{
+	// None of the tests sort, so the slots need no nodes behind them
+	store_ = new TransformStore();
+	for (unsigned int n = 0; n < 3; ++n) store_->allocate(NULL);
+}
+
+void TransformStoreTest::tearDown()
+{
+	delete store_;
+}
+
+void TransformStoreTest::testAllocate()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	CPPUNIT_ASSERT_EQUAL( 3u, store_->size() );
+	CPPUNIT_ASSERT_EQUAL( 3u, store_->allocate(NULL) );
+	CPPUNIT_ASSERT_EQUAL( 4u, store_->size() );
+
+	// New slots have no place in the order yet
+	CPPUNIT_ASSERT( !store_->isSorted() );
+	CPPUNIT_ASSERT_EQUAL( 0u, store_->getNumDirty() );
+}
+
+void TransformStoreTest::testClear()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	store_->invalidate(1);
+	store_->clear();
+
+	CPPUNIT_ASSERT_EQUAL( 0u, store_->size() );
+	CPPUNIT_ASSERT_EQUAL( 0u, store_->getTreeSize() );
+	CPPUNIT_ASSERT_EQUAL( 0u, store_->getNumDirty() );
+	CPPUNIT_ASSERT( store_->isSorted() );
+}
+
+void TransformStoreTest::testInvalidateListsOnce()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	store_->invalidate(1);
+	store_->invalidate(1);
+	store_->invalidate(2);
+	store_->invalidate(1);
+
+	CPPUNIT_ASSERT_EQUAL( 2u, store_->getNumDirty() );
+}
+
+void TransformStoreTest::testPruneDirty()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	store_->invalidate(0);
+	store_->invalidate(2);
+
+	// Nothing is valid again yet
+	store_->pruneDirty();
+	CPPUNIT_ASSERT_EQUAL( 2u, store_->getNumDirty() );
+
+	store_->derive(0);
+	store_->pruneDirty();
+	CPPUNIT_ASSERT_EQUAL( 1u, store_->getNumDirty() );
+
+	store_->derive(2);
+	store_->pruneDirty();
+	CPPUNIT_ASSERT_EQUAL( 0u, store_->getNumDirty() );
+}
+
+void TransformStoreTest::testDirtyListStaysBounded()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	// What SceneGraph::__deprecated_update() does to a node moved every frame
+	for (unsigned int frame = 0; frame < 1000; ++frame)
+	{
+		store_->invalidate(1);
+		store_->derive(1);
+		store_->pruneDirty();
+	}
+	CPPUNIT_ASSERT_EQUAL( 0u, store_->getNumDirty() );
+}
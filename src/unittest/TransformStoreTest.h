@@ -0,0 +1,49 @@
+/*
+ * TransformStoreTest.h
+ *
+ *  Created on: Mar 30, 2009
+ *      Author: yamokosk
+ */
+
+#ifndef TRANSFORMSTORETEST_H_
+#define TRANSFORMSTORETEST_H_
+
+// Logging
+#include <log4cxx/logger.h>
+// CppUnit
+#include <cppunit/extensions/HelperMacros.h>
+// Class to test
+#include <TransformStore.h>
+
+/*
+ * Slot bookkeeping and the dirty list of a store that is not part of a
+ * graph. Poses and sorting are covered through the graph in UpdateEngineTest.
+ */
+class TransformStoreTest : public CppUnit::TestFixture
+{
+	static log4cxx::LoggerPtr logger;
+
+	CPPUNIT_TEST_SUITE( TransformStoreTest );
+	CPPUNIT_TEST( testAllocate );
+	CPPUNIT_TEST( testClear );
+	CPPUNIT_TEST( testInvalidateListsOnce );
+	CPPUNIT_TEST( testPruneDirty );
+	CPPUNIT_TEST( testDirtyListStaysBounded );
+	CPPUNIT_TEST_SUITE_END();
+
+protected:
+	tinysg::TransformStore* store_;
+
+public:
+	void setUp();
+	void tearDown();
+
+protected:
+	void testAllocate();
+	void testClear();
+	void testInvalidateListsOnce();
+	void testPruneDirty();
+	void testDirtyListStaysBounded();
+};
+
+#endif /* TRANSFORMSTORETEST_H_ */
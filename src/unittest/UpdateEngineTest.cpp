@@ -0,0 +1,225 @@
+/*
+ * UpdateEngineTest.cpp
+ *
+ *  Created on: Mar 30, 2009
+ *      Author: yamokosk
+ */
+
+#include <cppunit/config/SourcePrefix.h>
+#include "UpdateEngineTest.h"
+
+#include <NodeUtils.h>
+
+#include <cstdlib>
+#include <sstream>
+
+using namespace log4cxx;
+using namespace tinysg;
+
+LoggerPtr UpdateEngineTest::logger(Logger::getLogger("UpdateEngineTest"));
+
+CPPUNIT_TEST_SUITE_REGISTRATION( UpdateEngineTest );
+
+// Large enough for the engine to split the tree into subtree tasks
+const unsigned int UpdateEngineTest::NumNodes = 2000;
+
+// Float rounding piles up along a branch, so poses are only compared this closely
+static const double Tolerance = 1e-4;
+
+std::vector<std::string> UpdateEngineTest::buildTree(SceneGraph& graph)
+{
+	std::srand(1);
+
+	std::vector<SceneNode*> nodes(1, graph.getNode(SceneGraph::World));
+	std::vector<std::string> names;
+	for (unsigned int n = 0; n < NumNodes; ++n)
+	{
+		std::stringstream ss;
+		ss << "node" << n;
+
+		SceneNode* child = nodes[ std::rand() % nodes.size() ]->createChild(ss.str());
+		translate(child, Vector3((Real)(std::rand() % 100) / 100, (Real)(std::rand() % 100) / 100, 0.5));
+		rotate(child, (n % 2) ? Vector3(0.0, 0.0, 1.0) : Vector3(1.0, 0.0, 0.0), (Real)(std::rand() % 100) / 100);
+
+		nodes.push_back(child);
+		names.push_back(ss.str());
+	}
+	return names;
+}
+
+void UpdateEngineTest::moveSome(SceneGraph& graph, const std::vector<std::string>& names, unsigned int seed)
+{
+	std::srand(seed);
+
+	for (unsigned int n = 0; n < names.size(); ++n)
+	{
+		if ( std::rand() % 10 != 0 ) continue;
+
+		SceneNode* node = graph.getNode(names[n]);
+		translate(node, Vector3(0.1, 0.0, -0.1));
+		rotate(node, Vector3(0.0, 1.0, 0.0), 0.05);
+	}
+}
+
+void UpdateEngineTest::assertSameWorldPoses(const SceneGraph& a, const SceneGraph& b,
+											const std::vector<std::string>& names)
+{
+	for (unsigned int n = 0; n < names.size(); ++n)
+	{
+		const Vector3& pa = a.getNode(names[n])->getPosition(TS_WORLD);
+		const Vector3& pb = b.getNode(names[n])->getPosition(TS_WORLD);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( pa.x, pb.x, Tolerance );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( pa.y, pb.y, Tolerance );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( pa.z, pb.z, Tolerance );
+
+		const Quaternion& qa = a.getNode(names[n])->getOrientation(TS_WORLD);
+		const Quaternion& qb = b.getNode(names[n])->getOrientation(TS_WORLD);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( qa.w, qb.w, Tolerance );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( qa.x, qb.x, Tolerance );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( qa.y, qb.y, Tolerance );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( qa.z, qb.z, Tolerance );
+	}
+}
+
+void UpdateEngineTest::setUp()
+{
+
+}
+
+void UpdateEngineTest::tearDown()
+{
+
+}
+
+void UpdateEngineTest::testMatchesDeprecatedUpdate()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	SceneGraph engine(4), reference(1);
+	std::vector<std::string> names = buildTree(engine);
+	buildTree(reference);
+
+	engine.update();
+	reference.__deprecated_update();
+	assertSameWorldPoses(engine, reference, names);
+
+	for (unsigned int frame = 0; frame < 3; ++frame)
+	{
+		moveSome(engine, names, frame + 2);
+		moveSome(reference, names, frame + 2);
+		engine.update();
+		reference.__deprecated_update();
+		assertSameWorldPoses(engine, reference, names);
+	}
+}
+
+void UpdateEngineTest::testThreadCountDoesNotMatter()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	SceneGraph serial(1), parallel(4);
+	std::vector<std::string> names = buildTree(serial);
+	buildTree(parallel);
+
+	serial.update();
+	parallel.update();
+	assertSameWorldPoses(serial, parallel, names);
+
+	moveSome(serial, names, 2);
+	moveSome(parallel, names, 2);
+	serial.update();
+	parallel.update();
+	assertSameWorldPoses(serial, parallel, names);
+	CPPUNIT_ASSERT_EQUAL( serial.getUpdateStats().recomputed, parallel.getUpdateStats().recomputed );
+}
+
+void UpdateEngineTest::testCleanSceneRecomputesNothing()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	SceneGraph graph(4);
+	buildTree(graph);
+
+	// Every node but the world node was moved into place
+	graph.update();
+	CPPUNIT_ASSERT_EQUAL( NumNodes, graph.getUpdateStats().recomputed );
+
+	graph.update();
+	CPPUNIT_ASSERT_EQUAL( 0u, graph.getUpdateStats().recomputed );
+}
+
+void UpdateEngineTest::testMovedNodeRecomputesSubtree()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	SceneGraph graph(4);
+	std::vector<std::string> names = buildTree(graph);
+	graph.update();
+
+	// The subtree of node0 hangs right off the world node, so it is big
+	SceneNode* moved = graph.getNode("node0");
+	unsigned int subtreeSize = 0;
+	for (unsigned int n = 0; n < names.size(); ++n)
+	{
+		for (SceneNode* node = graph.getNode(names[n]); node != NULL; node = node->getParent())
+		{
+			if ( node == moved ) { ++subtreeSize; break; }
+		}
+	}
+
+	translate(moved, Vector3(0.0, 0.0, 1.0));
+	graph.update();
+	CPPUNIT_ASSERT_EQUAL( subtreeSize, graph.getUpdateStats().recomputed );
+}
+
+void UpdateEngineTest::testReparentedSubtreeFollowsNewParent()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	SceneGraph graph(2);
+	SceneNode* world = graph.getNode(SceneGraph::World);
+	SceneNode* a = world->createChild("a");
+	SceneNode* b = a->createChild("b");
+	SceneNode* c = b->createChild("c");
+	SceneNode* d = world->createChild("d");
+	translate(a, Vector3(1.0, 0.0, 0.0), TS_PARENT);
+	translate(b, Vector3(0.0, 0.0, 1.0), TS_PARENT);
+	translate(c, Vector3(0.0, 0.0, 1.0), TS_PARENT);
+	translate(d, Vector3(0.0, 5.0, 0.0), TS_PARENT);
+	graph.update();
+
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( 1.0, c->getPosition(TS_WORLD).x, Tolerance );
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, c->getPosition(TS_WORLD).y, Tolerance );
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( 2.0, c->getPosition(TS_WORLD).z, Tolerance );
+
+	// Neither b nor c moved relative to their parent
+	a->removeChild(b);
+	d->addChild(b);
+	graph.update();
+
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, c->getPosition(TS_WORLD).x, Tolerance );
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( 5.0, c->getPosition(TS_WORLD).y, Tolerance );
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( 2.0, c->getPosition(TS_WORLD).z, Tolerance );
+}
+
+void UpdateEngineTest::testDetachedNodeUpdatedWhenAttached()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	SceneGraph graph(2);
+	SceneNode* a = graph.getNode(SceneGraph::World)->createChild("a");
+	SceneNode* b = graph.createNode("b");
+	translate(a, Vector3(1.0, 0.0, 0.0), TS_PARENT);
+	translate(b, Vector3(0.0, 2.0, 0.0), TS_PARENT);
+
+	// b is outside the world tree, so this update leaves it alone...
+	graph.update();
+
+	// ...but must not forget that it moved
+	a->addChild(b);
+	graph.update();
+
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( 1.0, b->getPosition(TS_WORLD).x, Tolerance );
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( 2.0, b->getPosition(TS_WORLD).y, Tolerance );
+	CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, b->getPosition(TS_WORLD).z, Tolerance );
+}
@@ -0,0 +1,58 @@
+/*
+ * UpdateEngineTest.h
+ *
+ *  Created on: Mar 30, 2009
+ *      Author: yamokosk
+ */
+
+#ifndef UPDATEENGINETEST_H_
+#define UPDATEENGINETEST_H_
+
+// Logging
+#include <log4cxx/logger.h>
+// CppUnit
+#include <cppunit/extensions/HelperMacros.h>
+// Class to test
+#include <SceneGraph.h>
+
+#include <string>
+#include <vector>
+
+class UpdateEngineTest : public CppUnit::TestFixture
+{
+	static log4cxx::LoggerPtr logger;
+
+	CPPUNIT_TEST_SUITE( UpdateEngineTest );
+	CPPUNIT_TEST( testMatchesDeprecatedUpdate );
+	CPPUNIT_TEST( testThreadCountDoesNotMatter );
+	CPPUNIT_TEST( testCleanSceneRecomputesNothing );
+	CPPUNIT_TEST( testMovedNodeRecomputesSubtree );
+	CPPUNIT_TEST( testReparentedSubtreeFollowsNewParent );
+	CPPUNIT_TEST( testDetachedNodeUpdatedWhenAttached );
+	CPPUNIT_TEST_SUITE_END();
+
+protected:
+	static const unsigned int NumNodes;
+
+	// Builds the same random tree into every graph it is given and returns
+	// the names of the nodes below the world node
+	static std::vector<std::string> buildTree(tinysg::SceneGraph& graph);
+	// Moves a random selection of the named nodes, the same ones for a given seed
+	static void moveSome(tinysg::SceneGraph& graph, const std::vector<std::string>& names, unsigned int seed);
+	static void assertSameWorldPoses(const tinysg::SceneGraph& a, const tinysg::SceneGraph& b,
+									 const std::vector<std::string>& names);
+
+public:
+	void setUp();
+	void tearDown();
+
+protected:
+	void testMatchesDeprecatedUpdate();
+	void testThreadCountDoesNotMatter();
+	void testCleanSceneRecomputesNothing();
+	void testMovedNodeRecomputesSubtree();
+	void testReparentedSubtreeFollowsNewParent();
+	void testDetachedNodeUpdatedWhenAttached();
+};
+
+#endif /* UPDATEENGINETEST_H_ */
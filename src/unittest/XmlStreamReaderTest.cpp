@@ -0,0 +1,140 @@
+/*
+ * XmlStreamReaderTest.cpp
+ *
+ *  Created on: Apr 6, 2009
+ *      Author: yamokosk
+ */
+
+#include <cppunit/config/SourcePrefix.h>
+#include "XmlStreamReaderTest.h"
+
+#include <Archive.h>
+#include <NodeUtils.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace log4cxx;
+using namespace tinysg;
+
+LoggerPtr XmlStreamReaderTest::logger(Logger::getLogger("XmlStreamReaderTest"));
+
+CPPUNIT_TEST_SUITE_REGISTRATION( XmlStreamReaderTest );
+
+const char* XmlStreamReaderTest::XmlFile = "XmlStreamReaderTest.xml";
+
+void XmlStreamReaderTest::writeScene(const std::string& nodeName)
+{
+	std::ofstream out(XmlFile);
+	out << "<?xml version=\"1.0\" ?>\n"
+		<< "<TinySG version=\"0\">\n"
+		<< "    <node name=\"_WORLD_\">\n"
+		<< "        <position value=\"0 0 0\" />\n"
+		<< "        <orientation format=\"AngleAxis\" angle=\"0\" axis=\"1 0 0\" />\n"
+		<< "    </node>\n"
+		<< "    <node name=\"" << nodeName << "\" parent=\"_WORLD_\">\n"
+		<< "        <position value=\"1 0 0\" />\n"
+		<< "        <orientation format=\"AngleAxis\" angle=\"0\" axis=\"0 0 1\" />\n"
+		<< "    </node>\n"
+		<< "</TinySG>\n";
+}
+
+std::string XmlStreamReaderTest::loadNodeName()
+{
+	SceneGraph graph(1);
+	int version = 0;
+	XmlStreamReader reader(XmlFile);
+	reader.load(graph, version);
+
+	SceneNode::ChildIterator children = graph.getNode(SceneGraph::World)->getChildren();
+	CPPUNIT_ASSERT( children.hasMoreElements() );
+	return children.getNext()->getName();
+}
+
+void XmlStreamReaderTest::setUp()
+{
+
+}
+
+void XmlStreamReaderTest::tearDown()
+{
+	std::remove(XmlFile);
+}
+
+void XmlStreamReaderTest::testMatchesDom()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	std::srand(1);
+	SceneGraph graph(1);
+	std::vector<SceneNode*> nodes(1, graph.getNode(SceneGraph::World));
+	for (unsigned int n = 0; n < 200; ++n)
+	{
+		SceneNode* child = nodes[ std::rand() % nodes.size() ]->createChild();
+		translate(child, Vector3((Real)(std::rand() % 100) / 10, 0.25, -(Real)n / 3));
+		rotate(child, Vector3(1.0, 0.0, 0.0), (Real)(std::rand() % 100) / 50);
+		nodes.push_back(child);
+	}
+	graph.update();
+	SceneLoader::save(XmlFile, graph, SF_XML);
+
+	int version = 0;
+	SceneGraph dom(1), stream(1);
+	IArchive ar(XmlFile);
+	ar.init();
+	ar.serialize(dom, version);
+	XmlStreamReader reader(XmlFile);
+	reader.load(stream, version);
+
+	for (unsigned int n = 1; n < nodes.size(); ++n)
+	{
+		SceneNode* a = dom.getNode(nodes[n]->getName());
+		SceneNode* b = stream.getNode(nodes[n]->getName());
+		CPPUNIT_ASSERT( b != NULL );
+		CPPUNIT_ASSERT_EQUAL( a->getParent()->getName(), b->getParent()->getName() );
+
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( a->getPosition().x, b->getPosition().x, 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( a->getPosition().y, b->getPosition().y, 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( a->getPosition().z, b->getPosition().z, 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( a->getOrientation().w, b->getOrientation().w, 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( a->getOrientation().x, b->getOrientation().x, 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( a->getOrientation().y, b->getOrientation().y, 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( a->getOrientation().z, b->getOrientation().z, 1e-6 );
+	}
+}
+
+void XmlStreamReaderTest::testNamedEntities()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	writeScene("a&amp;b&lt;c&gt;&quot;d&apos;&unknown;");
+	CPPUNIT_ASSERT_EQUAL( std::string("a&b<c>\"d'&unknown;"), loadNodeName() );
+}
+
+void XmlStreamReaderTest::testCharacterReferences()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	// One, two, three and four byte UTF-8
+	writeScene("&#65;&#xE9;&#x20AC;&#x1F600;");
+	CPPUNIT_ASSERT_EQUAL( std::string("A\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80"), loadNodeName() );
+}
+
+void XmlStreamReaderTest::testReferencePastUnicode()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	writeScene("a&#x110000;");
+	CPPUNIT_ASSERT_EQUAL( std::string("a&#x110000;"), loadNodeName() );
+}
+
+void XmlStreamReaderTest::testMalformedEntity()
+{
+	LOG4CXX_INFO(logger, "Test: " << __FUNCTION__);
+
+	writeScene("a&nosemicolonhere");
+	CPPUNIT_ASSERT_THROW( loadNodeName(), std::string );
+}
@@ -0,0 +1,54 @@
+/*
+ * XmlStreamReaderTest.h
+ *
+ *  Created on: Apr 6, 2009
+ *      Author: yamokosk
+ */
+
+#ifndef XMLSTREAMREADERTEST_H_
+#define XMLSTREAMREADERTEST_H_
+
+// Logging
+#include <log4cxx/logger.h>
+// CppUnit
+#include <cppunit/extensions/HelperMacros.h>
+// Class to test
+#include <XmlStreamReader.h>
+#include <SceneGraph.h>
+
+#include <string>
+
+class XmlStreamReaderTest : public CppUnit::TestFixture
+{
+	static log4cxx::LoggerPtr logger;
+
+	CPPUNIT_TEST_SUITE( XmlStreamReaderTest );
+	CPPUNIT_TEST( testMatchesDom );
+	CPPUNIT_TEST( testNamedEntities );
+	CPPUNIT_TEST( testCharacterReferences );
+	CPPUNIT_TEST( testReferencePastUnicode );
+	CPPUNIT_TEST( testMalformedEntity );
+	CPPUNIT_TEST_SUITE_END();
+
+protected:
+	static const char* XmlFile;
+
+	// Writes a scene with one node, named exactly as given, below the world node
+	static void writeScene(const std::string& nodeName);
+	// Loads XmlFile with the streaming reader and returns the name of the
+	// world node's first child
+	static std::string loadNodeName();
+
+public:
+	void setUp();
+	void tearDown();
+
+protected:
+	void testMatchesDom();
+	void testNamedEntities();
+	void testCharacterReferences();
+	void testReferencePastUnicode();
+	void testMalformedEntity();
+};
+
+#endif /* XMLSTREAMREADERTEST_H_ */